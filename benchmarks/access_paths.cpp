@@ -0,0 +1,188 @@
+/* Compares the ways of accessing the value of a Mutexed across inner mutex types.
+
+   Most benchmarks take two arguments :
+   * `read%` : the percentage of the accesses that are read-only,
+   * `cs` : the length of the critical section, in steps of read_work()/write_work().
+   and are run with 1 to max_threads() threads sharing the same Mutexed.
+
+   Run with `--benchmark_out=<file> --benchmark_out_format=json` (or build the
+   `benchmarks_json` target) to get the results as JSON.
+ */
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <utility>
+
+#include "bench_common.hpp"
+#include "mutexed.hpp"
+
+using namespace llh::mutexed;
+using namespace llh::mutexed::bench;
+
+namespace {
+
+template<typename M>
+Mutexed<payload, M>& shared_payload() {
+    static Mutexed<payload, M> m;
+    return m;
+}
+
+template<typename M, int I>
+Mutexed<payload, M>& shared_payload_n() {
+    static Mutexed<payload, M> m;
+    return m;
+}
+
+void access_args(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"read%", "cs"})
+     ->ArgsProduct({{0, 50, 90, 100}, {0, 64, 1024}})
+     ->ThreadRange(1, max_threads())
+     ->UseRealTime();
+}
+
+template<typename M>
+void BM_WithLocked(benchmark::State& state) {
+    auto& m = shared_payload<M>();
+    auto const read_percent = state.range(0);
+    auto const cs_len = state.range(1);
+    std::int64_t i = 0;
+    for (auto _ : state) {
+        if (is_read(i++, read_percent)) {
+            std::as_const(m).with_locked([cs_len](payload const& p) { read_work(p, cs_len); });
+        } else {
+            m.with_locked([cs_len](payload& p) { write_work(p, cs_len); });
+        }
+    }
+}
+
+template<typename M>
+void BM_Locked(benchmark::State& state) {
+    auto& m = shared_payload<M>();
+    auto const read_percent = state.range(0);
+    auto const cs_len = state.range(1);
+    std::int64_t i = 0;
+    for (auto _ : state) {
+        if (is_read(i++, read_percent)) {
+            auto [lock, p] = m.locked_const();
+            read_work(p, cs_len);
+        } else {
+            auto [lock, p] = m.locked();
+            write_work(p, cs_len);
+        }
+    }
+}
+
+template<typename M>
+void BM_GetCopy(benchmark::State& state) {
+    auto& m = shared_payload<M>();
+    auto const read_percent = state.range(0);
+    auto const cs_len = state.range(1);
+    std::int64_t i = 0;
+    for (auto _ : state) {
+        if (is_read(i++, read_percent)) {
+            payload copy = m.get_copy();
+            read_work(copy, cs_len);
+        } else {
+            m.with_locked([cs_len](payload& p) { write_work(p, cs_len); });
+        }
+    }
+}
+
+template<typename M>
+void BM_GetSnapshot(benchmark::State& state) {
+    static Mutexed<payload, M, no_cv, has_snapshot> m;
+    auto const read_percent = state.range(0);
+    auto const cs_len = state.range(1);
+    std::int64_t i = 0;
+    for (auto _ : state) {
+        if (is_read(i++, read_percent)) {
+            auto snapshot = m.get_snapshot();
+            read_work(*snapshot, cs_len);
+        } else {
+            m.with_locked([cs_len](payload& p) { write_work(p, cs_len); });
+        }
+    }
+}
+
+template<typename M>
+void BM_WithAllLocked(benchmark::State& state) {
+    auto& a = shared_payload_n<M, 0>();
+    auto& b = shared_payload_n<M, 1>();
+    auto const read_percent = state.range(0);
+    auto const cs_len = state.range(1);
+    std::int64_t i = 0;
+    for (auto _ : state) {
+        if (is_read(i++, read_percent)) {
+            with_all_locked([cs_len](payload const& pa, payload const& pb) {
+                    read_work(pa, cs_len);
+                    read_work(pb, cs_len);
+                },
+                std::cref(a), std::cref(b));
+        } else {
+            with_all_locked([cs_len](payload& pa, payload const& pb) {
+                    write_work(pa, cs_len);
+                    read_work(pb, cs_len);
+                },
+                a, std::cref(b));
+        }
+    }
+}
+
+/* Measures round trips between two threads, each waking the other with a
+   mutable with_locked() on the Mutexed the other one is waiting on.
+   A round trip is made of two wake-ups.
+ */
+template<typename M>
+void BM_WaitWake(benchmark::State& state) {
+    constexpr auto stop = std::numeric_limits<std::uint64_t>::max();
+    Mutexed<std::uint64_t, M, has_cv> ping(0u);
+    Mutexed<std::uint64_t, M, has_cv> pong(0u);
+
+    std::thread responder([&]() {
+        std::uint64_t seen = 0;
+        while (seen != stop) {
+            ping.wait([&seen](std::uint64_t v) { return v != seen; });
+            seen = ping.get_copy();
+            pong.with_locked([seen](std::uint64_t& v) { v = seen; });
+        }
+    });
+
+    std::uint64_t i = 0;
+    for (auto _ : state) {
+        ++i;
+        ping.with_locked([i](std::uint64_t& v) { v = i; });
+        pong.wait([i](std::uint64_t v) { return v == i; });
+    }
+    ping.with_locked([](std::uint64_t& v) { v = stop; });
+    responder.join();
+
+    state.SetItemsProcessed(2 * state.iterations());
+}
+
+} // end anonymous namespace
+
+BENCHMARK_TEMPLATE(BM_WithLocked, std::mutex)->Apply(access_args);
+BENCHMARK_TEMPLATE(BM_WithLocked, std::shared_mutex)->Apply(access_args);
+BENCHMARK_TEMPLATE(BM_WithLocked, spin_mutex)->Apply(access_args);
+
+BENCHMARK_TEMPLATE(BM_Locked, std::mutex)->Apply(access_args);
+BENCHMARK_TEMPLATE(BM_Locked, std::shared_mutex)->Apply(access_args);
+BENCHMARK_TEMPLATE(BM_Locked, spin_mutex)->Apply(access_args);
+
+BENCHMARK_TEMPLATE(BM_GetCopy, std::mutex)->Apply(access_args);
+BENCHMARK_TEMPLATE(BM_GetCopy, std::shared_mutex)->Apply(access_args);
+BENCHMARK_TEMPLATE(BM_GetCopy, spin_mutex)->Apply(access_args);
+
+BENCHMARK_TEMPLATE(BM_GetSnapshot, std::mutex)->Apply(access_args);
+BENCHMARK_TEMPLATE(BM_GetSnapshot, std::shared_mutex)->Apply(access_args);
+BENCHMARK_TEMPLATE(BM_GetSnapshot, spin_mutex)->Apply(access_args);
+
+BENCHMARK_TEMPLATE(BM_WithAllLocked, std::mutex)->Apply(access_args);
+BENCHMARK_TEMPLATE(BM_WithAllLocked, std::shared_mutex)->Apply(access_args);
+BENCHMARK_TEMPLATE(BM_WithAllLocked, spin_mutex)->Apply(access_args);
+
+BENCHMARK_TEMPLATE(BM_WaitWake, std::mutex)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_WaitWake, std::shared_mutex)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_WaitWake, spin_mutex)->UseRealTime();
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace llh::mutexed::bench {
+
+//! A test-and-test-and-set spinlock, standing for the user-provided mutexes.
+class spin_mutex {
+    std::atomic<bool> locked_{false};
+
+public:
+    void lock() {
+        while (locked_.exchange(true, std::memory_order_acquire)) {
+            while (locked_.load(std::memory_order_relaxed)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+    bool try_lock() {
+        return !locked_.load(std::memory_order_relaxed) &&
+               !locked_.exchange(true, std::memory_order_acquire);
+    }
+    void unlock() { locked_.store(false, std::memory_order_release); }
+};
+
+//! The protected value of the benchmarks : a cache line worth of data.
+struct payload {
+    std::array<std::uint64_t, 8> words{};
+};
+
+//! Simulates a read-only critical section of @a len steps.
+inline void read_work(payload const& p, std::int64_t len) {
+    std::uint64_t sum = p.words[0];
+    for (std::int64_t i = 0; i < len; ++i) {
+        sum += p.words[i % p.words.size()];
+        benchmark::DoNotOptimize(sum);
+    }
+    benchmark::DoNotOptimize(sum);
+}
+
+//! Simulates a writing critical section of @a len steps.
+inline void write_work(payload& p, std::int64_t len) {
+    ++p.words[0];
+    for (std::int64_t i = 0; i < len; ++i) {
+        ++p.words[i % p.words.size()];
+        benchmark::ClobberMemory();
+    }
+}
+
+//! Spreads the reads evenly among the iterations so that @a read_percent of them are reads.
+inline bool is_read(std::int64_t iteration, std::int64_t read_percent) {
+    return (iteration * 37) % 100 < read_percent;
+}
+
+//! The highest number of threads the benchmarks are run with.
+inline int max_threads() {
+    return static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+}
+
+} // end namespace llh::mutexed::bench
@@ -0,0 +1,112 @@
+/* Benchmarks of bounded_queue against the naive blocking queue that is a
+   `Mutexed<std::deque<T>, std::mutex, has_cv>` used with wait() and the
+   mutable with_locked(), which notifies all the waiters at every push and pop.
+
+   Half of the threads produce and the other half consume, the same number of
+   elements each, through a queue of 256 elements. The batched benchmarks move
+   up to 32 elements per lock.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "mutexed/bounded_queue.hpp"
+
+using namespace llh::mutexed;
+using namespace llh::mutexed::bench;
+
+namespace {
+
+constexpr std::size_t queue_capacity = 256;
+constexpr std::size_t batch_size = 32;
+
+//! The naive blocking queue, bounded to the same capacity.
+struct naive_queue {
+    Mutexed<std::deque<std::uint64_t>, std::mutex, has_cv> items;
+
+    void push(std::uint64_t v) {
+        items.wait([](auto const& q) { return q.size() < queue_capacity; });
+        // Another producer may have filled the queue since, which only makes it a bit larger.
+        items.with_locked([v](std::deque<std::uint64_t>& q) { q.push_back(v); });
+    }
+
+    std::uint64_t pop() {
+        std::uint64_t v = 0;
+        while (!items.with_locked([&v](std::deque<std::uint64_t>& q) {
+            if (q.empty()) {
+                return false;
+            }
+            v = q.front();
+            q.pop_front();
+            return true;
+        })) {
+            items.wait([](auto const& q) { return !q.empty(); });
+        }
+        return v;
+    }
+};
+
+template<typename Q>
+void run_single(benchmark::State& state, Q& queue) {
+    bool const producer = state.thread_index() % 2 == 0;
+    std::uint64_t i = 0;
+    for (auto _ : state) {
+        if (producer) {
+            queue.push(++i);
+        } else {
+            benchmark::DoNotOptimize(queue.pop());
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_NaiveQueue(benchmark::State& state) {
+    static naive_queue queue;
+    run_single(state, queue);
+}
+
+template<typename Storage>
+void BM_BoundedQueue(benchmark::State& state) {
+    static bounded_queue<std::uint64_t, std::mutex, Storage> queue(queue_capacity);
+    run_single(state, queue);
+}
+
+/* Each iteration moves a batch of batch_size elements. The consumers call
+   pop_n() until they have received a whole batch.
+ */
+void BM_BoundedQueueBatches(benchmark::State& state) {
+    static bounded_queue<std::uint64_t> queue(queue_capacity);
+    bool const producer = state.thread_index() % 2 == 0;
+    std::vector<std::uint64_t> batch(batch_size);
+    for (auto _ : state) {
+        if (producer) {
+            queue.push_n(batch.begin(), batch.end());
+        } else {
+            std::size_t received = 0;
+            while (received < batch_size) {
+                received += queue.pop_n(batch.begin() + static_cast<std::ptrdiff_t>(received), batch_size - received);
+            }
+            benchmark::DoNotOptimize(batch.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(batch_size));
+}
+
+void thread_pairs(benchmark::internal::Benchmark* b) {
+    for (int threads = 2; threads <= max_threads(); threads *= 2) {
+        b->Threads(threads);
+    }
+    b->UseRealTime();
+}
+
+} // end anonymous namespace
+
+BENCHMARK(BM_NaiveQueue)->Apply(thread_pairs);
+BENCHMARK_TEMPLATE(BM_BoundedQueue, ring_buffer<std::uint64_t>)->Apply(thread_pairs);
+BENCHMARK_TEMPLATE(BM_BoundedQueue, std::deque<std::uint64_t>)->Apply(thread_pairs);
+BENCHMARK(BM_BoundedQueueBatches)->Apply(thread_pairs);
@@ -0,0 +1,107 @@
+/* Benchmarks of the hit path of clock_cache against a list-based LRU cache
+   in a single Mutexed, whose hits move their entry to the front of the list
+   under the exclusive lock.
+
+   The caches hold every key that is looked up, so that all the lookups are
+   hits, spread evenly over 4096 keys. The single-shard clock_cache isolates
+   the gain of the shared locks from the one of the sharding.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "bench_common.hpp"
+#include "mutexed/clock_cache.hpp"
+
+using namespace llh::mutexed;
+using namespace llh::mutexed::bench;
+
+namespace {
+
+constexpr std::uint64_t nb_keys = 4096;
+
+//! The usual LRU cache : a recency list and an index of its nodes.
+class lru_cache {
+    std::size_t capacity_;
+    std::list<std::pair<std::uint64_t, payload>> recency_;
+    std::unordered_map<std::uint64_t, decltype(recency_)::iterator> index_;
+
+public:
+    explicit lru_cache(std::size_t capacity) : capacity_(capacity) {}
+
+    std::optional<payload> get(std::uint64_t key) {
+        auto const it = index_.find(key);
+        if (it == index_.end()) {
+            return std::nullopt;
+        }
+        recency_.splice(recency_.begin(), recency_, it->second);
+        return it->second->second;
+    }
+
+    void put(std::uint64_t key, payload const& value) {
+        if (index_.size() == capacity_) {
+            index_.erase(recency_.back().first);
+            recency_.pop_back();
+        }
+        recency_.emplace_front(key, value);
+        index_.emplace(key, recency_.begin());
+    }
+};
+
+//! The key of the i-th lookup of a thread, spread so that threads do not walk in step.
+std::uint64_t key_of(std::uint64_t i, int thread) {
+    return (i * 2654435761u + static_cast<std::uint64_t>(thread) * 977u) % nb_keys;
+}
+
+void BM_LruHit(benchmark::State& state) {
+    static Mutexed<lru_cache, std::mutex> cache(nb_keys);
+    if (state.thread_index() == 0) {
+        cache.with_locked([](lru_cache& c) {
+            for (std::uint64_t k = 0; k < nb_keys; ++k) {
+                if (!c.get(k)) {
+                    c.put(k, payload{});
+                }
+            }
+        });
+    }
+    std::uint64_t i = 0;
+    for (auto _ : state) {
+        auto const key = key_of(++i, state.thread_index());
+        // A hit reorders the list, so even a lookup is a write-access.
+        benchmark::DoNotOptimize(cache.with_locked([key](lru_cache& c) { return c.get(key); }));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template<typename M, std::size_t NbShards>
+void BM_ClockHit(benchmark::State& state) {
+    static clock_cache<std::uint64_t, payload, std::hash<std::uint64_t>, std::equal_to<std::uint64_t>, M> cache(
+        2 * nb_keys, NbShards);
+    if (state.thread_index() == 0) {
+        for (std::uint64_t k = 0; k < nb_keys; ++k) {
+            cache.insert_or_assign(k, payload{});
+        }
+    }
+    std::uint64_t i = 0;
+    for (auto _ : state) {
+        auto const key = key_of(++i, state.thread_index());
+        benchmark::DoNotOptimize(cache.find_copy(key));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void hit_threads(benchmark::internal::Benchmark* b) {
+    b->ThreadRange(1, 64)->UseRealTime();
+}
+
+} // end anonymous namespace
+
+BENCHMARK(BM_LruHit)->Apply(hit_threads);
+BENCHMARK_TEMPLATE(BM_ClockHit, std::shared_mutex, 1)->Apply(hit_threads);
+BENCHMARK_TEMPLATE(BM_ClockHit, std::mutex, 64)->Apply(hit_threads);
+BENCHMARK_TEMPLATE(BM_ClockHit, std::shared_mutex, 64)->Apply(hit_threads);
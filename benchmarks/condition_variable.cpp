@@ -0,0 +1,183 @@
+/* Benchmarks of the waiting API of Mutexed<T, M, has_cv>, used as a signaling primitive.
+
+   `std::mutex` gets a `std::condition_variable` while every other mutex type
+   gets a `std::condition_variable_any`. any_cv_mutex is a `std::mutex` that
+   does not match that specialization, so comparing the two isolates the cost
+   of the type of condition-variable.
+
+   The latencies are measured with manual timing, from the end of the functor
+   of the mutable with_locked() to the moment the waiter observes its
+   predicate as true, so they include the unlocking and the notification.
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "mutexed.hpp"
+
+using namespace llh::mutexed;
+using namespace llh::mutexed::bench;
+
+namespace {
+
+using bench_clock = std::chrono::steady_clock;
+
+//! A `std::mutex` for which Mutexed uses a `std::condition_variable_any`.
+struct any_cv_mutex : std::mutex {};
+
+constexpr auto stop = std::numeric_limits<std::uint64_t>::max();
+
+//! Waits until @a counter reaches @a target.
+void wait_for_count(std::atomic<std::int64_t>& counter, std::int64_t target) {
+    for (auto current = counter.load(); current < target; current = counter.load()) {
+        counter.wait(current);
+    }
+}
+
+/* Starts waiting threads that each count themselves in @a parked when their
+   predicate first returns false for a generation, which guarantees that they
+   are blocked on the condition-variable once the writer has acquired the
+   mutex, and count themselves in @a woken once they have observed the next
+   generation. The latest wake-up time is kept in @a last_woken_at.
+ */
+template<typename M>
+std::vector<std::thread> start_waiters(
+    std::int64_t nb,
+    Mutexed<std::uint64_t, M, has_cv>& gen,
+    std::atomic<std::int64_t>& parked,
+    std::atomic<std::int64_t>& woken,
+    std::atomic<bench_clock::rep>& last_woken_at)
+{
+    std::vector<std::thread> waiters;
+    waiters.reserve(static_cast<std::size_t>(nb));
+    for (std::int64_t i = 0; i < nb; ++i) {
+        waiters.emplace_back([&]() {
+            std::uint64_t seen = 0;
+            while (seen != stop) {
+                bool counted = false;
+                gen.wait([&](std::uint64_t g) {
+                    if (g != seen) {
+                        seen = g;
+                        return true;
+                    }
+                    if (!counted) {
+                        counted = true;
+                        parked.fetch_add(1);
+                    }
+                    return false;
+                });
+                auto now = bench_clock::now().time_since_epoch().count();
+                auto last = last_woken_at.load();
+                while (last < now && !last_woken_at.compare_exchange_weak(last, now)) {}
+                woken.fetch_add(1);
+                woken.notify_one();
+            }
+        });
+    }
+    return waiters;
+}
+
+/* Measures the time it takes for @a nb waiters to all observe a change,
+   with 1 waiter being the wake-up latency.
+ */
+template<typename M>
+void BM_WakeWaiters(benchmark::State& state) {
+    auto const nb = state.range(0);
+    Mutexed<std::uint64_t, M, has_cv> gen(0u);
+    std::atomic<std::int64_t> parked{0};
+    std::atomic<std::int64_t> woken{0};
+    std::atomic<bench_clock::rep> last_woken_at{0};
+    auto waiters = start_waiters(nb, gen, parked, woken, last_woken_at);
+
+    std::int64_t round = 0;
+    for (auto _ : state) {
+        while (parked.load() < nb * (round + 1)) {
+            std::this_thread::yield();
+        }
+        ++round;
+        bench_clock::time_point written_at;
+        gen.with_locked([&](std::uint64_t& g) {
+            ++g;
+            written_at = bench_clock::now();
+        });
+        wait_for_count(woken, nb * round);
+
+        auto const last = bench_clock::time_point(bench_clock::duration(last_woken_at.load()));
+        state.SetIterationTime(std::chrono::duration<double>(last - written_at).count());
+    }
+
+    gen.with_locked([](std::uint64_t& g) { g = stop; });
+    for (auto& w : waiters) {
+        w.join();
+    }
+    state.SetItemsProcessed(nb * state.iterations());
+}
+
+/* Measures the throughput of two threads waking each other in turns through
+   two Mutexed. A round trip is made of two wake-ups.
+ */
+template<typename M>
+void BM_PingPong(benchmark::State& state) {
+    Mutexed<std::uint64_t, M, has_cv> ping(0u);
+    Mutexed<std::uint64_t, M, has_cv> pong(0u);
+
+    std::thread responder([&]() {
+        std::uint64_t seen = 0;
+        while (seen != stop) {
+            ping.wait([&seen](std::uint64_t v) {
+                if (v == seen) {
+                    return false;
+                }
+                seen = v;
+                return true;
+            });
+            pong.with_locked([seen](std::uint64_t& v) { v = seen; });
+        }
+    });
+
+    std::uint64_t i = 0;
+    for (auto _ : state) {
+        ++i;
+        ping.with_locked([i](std::uint64_t& v) { v = i; });
+        pong.wait([i](std::uint64_t v) { return v == i; });
+    }
+    ping.with_locked([](std::uint64_t& v) { v = stop; });
+    responder.join();
+
+    state.SetItemsProcessed(2 * state.iterations());
+}
+
+/* Measures the cost of a mutable with_locked() that notifies nobody, which is
+   what every writer pays for enabling the waiting API.
+ */
+template<typename M>
+void BM_NotifyWithoutWaiters(benchmark::State& state) {
+    Mutexed<std::uint64_t, M, has_cv> m(0u);
+    for (auto _ : state) {
+        m.with_locked([](std::uint64_t& v) { ++v; });
+    }
+}
+
+void waiters_args(benchmark::internal::Benchmark* b) {
+    b->ArgName("waiters")->Arg(1)->Arg(10)->Arg(100)->Arg(1000)->UseManualTime();
+}
+
+} // end anonymous namespace
+
+BENCHMARK_TEMPLATE(BM_WakeWaiters, std::mutex)->Apply(waiters_args);
+BENCHMARK_TEMPLATE(BM_WakeWaiters, any_cv_mutex)->Apply(waiters_args);
+BENCHMARK_TEMPLATE(BM_WakeWaiters, std::shared_mutex)->Apply(waiters_args);
+
+BENCHMARK_TEMPLATE(BM_PingPong, std::mutex)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PingPong, any_cv_mutex)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PingPong, std::shared_mutex)->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_NotifyWithoutWaiters, std::mutex);
+BENCHMARK_TEMPLATE(BM_NotifyWithoutWaiters, any_cv_mutex);
+BENCHMARK_TEMPLATE(BM_NotifyWithoutWaiters, std::shared_mutex);
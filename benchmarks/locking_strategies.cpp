@@ -0,0 +1,67 @@
+/* Compares the acquisition strategies of with_all_locked() : backoff_locking
+   (std::lock()) and ordered_locking, for 2, 4, 8 and 16 Mutexed shared by all
+   the threads.
+
+   Every thread passes the Mutexed in a different rotation of their order,
+   which is what makes std::lock() back off under contention.
+   The argument `cs` is the length of the critical section, in steps of
+   write_work() per Mutexed.
+ */
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+
+#include "bench_common.hpp"
+#include "mutexed.hpp"
+
+using namespace llh::mutexed;
+using namespace llh::mutexed::bench;
+
+namespace {
+
+template<typename M, std::size_t N>
+std::array<Mutexed<payload, M>, N>& shared_payloads() {
+    static std::array<Mutexed<payload, M>, N> payloads;
+    return payloads;
+}
+
+template<typename Locking, typename M, std::size_t N>
+void BM_WithAllLocked(benchmark::State& state) {
+    auto& payloads = shared_payloads<M, N>();
+    auto const rotation = static_cast<std::size_t>(state.thread_index());
+    auto const cs_len = state.range(0);
+
+    auto write_all = [cs_len](auto&... p) { (write_work(p, cs_len), ...); };
+    for (auto _ : state) {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            with_all_locked(Locking{}, write_all, payloads[(I + rotation) % N]...);
+        }(std::make_index_sequence<N>{});
+    }
+}
+
+void strategies_args(benchmark::internal::Benchmark* b) {
+    b->ArgName("cs")->Arg(0)->Arg(64)->ThreadRange(1, max_threads())->UseRealTime();
+}
+
+} // end anonymous namespace
+
+BENCHMARK_TEMPLATE(BM_WithAllLocked, backoff_locking_t, std::mutex, 2)->Apply(strategies_args);
+BENCHMARK_TEMPLATE(BM_WithAllLocked, ordered_locking_t, std::mutex, 2)->Apply(strategies_args);
+BENCHMARK_TEMPLATE(BM_WithAllLocked, backoff_locking_t, std::mutex, 4)->Apply(strategies_args);
+BENCHMARK_TEMPLATE(BM_WithAllLocked, ordered_locking_t, std::mutex, 4)->Apply(strategies_args);
+BENCHMARK_TEMPLATE(BM_WithAllLocked, backoff_locking_t, std::mutex, 8)->Apply(strategies_args);
+BENCHMARK_TEMPLATE(BM_WithAllLocked, ordered_locking_t, std::mutex, 8)->Apply(strategies_args);
+BENCHMARK_TEMPLATE(BM_WithAllLocked, backoff_locking_t, std::mutex, 16)->Apply(strategies_args);
+BENCHMARK_TEMPLATE(BM_WithAllLocked, ordered_locking_t, std::mutex, 16)->Apply(strategies_args);
+
+BENCHMARK_TEMPLATE(BM_WithAllLocked, backoff_locking_t, std::shared_mutex, 2)->Apply(strategies_args);
+BENCHMARK_TEMPLATE(BM_WithAllLocked, ordered_locking_t, std::shared_mutex, 2)->Apply(strategies_args);
+BENCHMARK_TEMPLATE(BM_WithAllLocked, backoff_locking_t, std::shared_mutex, 4)->Apply(strategies_args);
+BENCHMARK_TEMPLATE(BM_WithAllLocked, ordered_locking_t, std::shared_mutex, 4)->Apply(strategies_args);
+BENCHMARK_TEMPLATE(BM_WithAllLocked, backoff_locking_t, std::shared_mutex, 8)->Apply(strategies_args);
+BENCHMARK_TEMPLATE(BM_WithAllLocked, ordered_locking_t, std::shared_mutex, 8)->Apply(strategies_args);
+BENCHMARK_TEMPLATE(BM_WithAllLocked, backoff_locking_t, std::shared_mutex, 16)->Apply(strategies_args);
+BENCHMARK_TEMPLATE(BM_WithAllLocked, ordered_locking_t, std::shared_mutex, 16)->Apply(strategies_args);
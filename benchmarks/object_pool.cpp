@@ -0,0 +1,78 @@
+/* Benchmarks of object_pool against the single-lock pool that is a
+   `Mutexed<std::vector<std::unique_ptr<T>>>` free list.
+
+   Each iteration acquires a burst of objects and releases them, a burst of
+   1 being the alternating pattern that never reaches the depot of
+   object_pool, and a burst of 256 making it exchange a batch every 32
+   acquisitions or releases.
+ */
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "mutexed/object_pool.hpp"
+
+using namespace llh::mutexed;
+using namespace llh::mutexed::bench;
+
+namespace {
+
+//! The single-lock pool.
+class locked_pool {
+    Mutexed<std::vector<std::unique_ptr<payload>>, std::mutex> free_;
+
+public:
+    std::unique_ptr<payload> acquire() {
+        auto pooled = free_.with_locked([](std::vector<std::unique_ptr<payload>>& free) {
+            std::unique_ptr<payload> last;
+            if (!free.empty()) {
+                last = std::move(free.back());
+                free.pop_back();
+            }
+            return last;
+        });
+        return pooled ? std::move(pooled) : std::make_unique<payload>();
+    }
+
+    void release(std::unique_ptr<payload> obj) {
+        free_.with_locked([&obj](std::vector<std::unique_ptr<payload>>& free) { free.push_back(std::move(obj)); });
+    }
+};
+
+template<typename Pool>
+void run_bursts(benchmark::State& state, Pool& pool) {
+    auto const burst = static_cast<std::size_t>(state.range(0));
+    std::vector<std::unique_ptr<payload>> held;
+    held.reserve(burst);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < burst; ++i) {
+            held.push_back(pool.acquire());
+        }
+        for (auto& p : held) {
+            pool.release(std::move(p));
+        }
+        held.clear();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_LockedPool(benchmark::State& state) {
+    static locked_pool pool;
+    run_bursts(state, pool);
+}
+
+void BM_ObjectPool(benchmark::State& state) {
+    static object_pool<payload> pool;
+    run_bursts(state, pool);
+}
+
+void burst_args(benchmark::internal::Benchmark* b) {
+    b->ArgName("burst")->Arg(1)->Arg(256)->ThreadRange(1, max_threads())->UseRealTime();
+}
+
+} // end anonymous namespace
+
+BENCHMARK(BM_LockedPool)->Apply(burst_args);
+BENCHMARK(BM_ObjectPool)->Apply(burst_args);
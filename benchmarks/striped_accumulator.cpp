@@ -0,0 +1,48 @@
+/* Benchmarks of the increments of a striped_accumulator against those of a
+   single Mutexed<std::int64_t>, whose mutex and value share a cache line that
+   every writer pulls to its core.
+ */
+#include <cstdint>
+#include <mutex>
+
+#include "bench_common.hpp"
+#include "mutexed/striped_accumulator.hpp"
+
+using namespace llh::mutexed;
+using namespace llh::mutexed::bench;
+
+namespace {
+
+template<typename M>
+void BM_MutexedIncrement(benchmark::State& state) {
+    static Mutexed<std::int64_t, M> counter(0);
+    for (auto _ : state) {
+        counter.with_locked([](std::int64_t& v) { ++v; });
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template<typename M>
+void BM_StripedIncrement(benchmark::State& state) {
+    static striped_accumulator<std::int64_t, std::plus<std::int64_t>, M> counter;
+    for (auto _ : state) {
+        counter.with_locked([](std::int64_t& v) { ++v; });
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+//! The cost of a read, which locks and reduces all the stripes.
+void BM_StripedRead(benchmark::State& state) {
+    static striped_accumulator<std::int64_t> counter;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(counter.get_copy());
+    }
+}
+
+} // end anonymous namespace
+
+BENCHMARK_TEMPLATE(BM_MutexedIncrement, std::mutex)->ThreadRange(1, max_threads())->UseRealTime();
+BENCHMARK_TEMPLATE(BM_MutexedIncrement, spin_mutex)->ThreadRange(1, max_threads())->UseRealTime();
+BENCHMARK_TEMPLATE(BM_StripedIncrement, std::mutex)->ThreadRange(1, max_threads())->UseRealTime();
+BENCHMARK_TEMPLATE(BM_StripedIncrement, spin_mutex)->ThreadRange(1, max_threads())->UseRealTime();
+BENCHMARK(BM_StripedRead);
@@ -1,11 +1,86 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <shared_mutex>
 #include <mutex>
 #include <type_traits>
 #include <utility>
 #include <functional>
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <tuple>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <span>
+
+/* Clang's thread-safety analysis attributes (`-Wthread-safety`), only those
+   used by this library. They expand to nothing on other compilers or when
+   LLH_MUTEXED_NO_THREAD_SAFETY_ANNOTATIONS is defined.
+ */
+#if defined(__clang__) && !defined(LLH_MUTEXED_NO_THREAD_SAFETY_ANNOTATIONS)
+#define LLH_MUTEXED_TSA(x) __attribute__((x))
+#else
+#define LLH_MUTEXED_TSA(x)
+#endif
+
+#define LLH_MUTEXED_CAPABILITY(x)           LLH_MUTEXED_TSA(capability(x))
+#define LLH_MUTEXED_REQUIRES(...)           LLH_MUTEXED_TSA(requires_capability(__VA_ARGS__))
+#define LLH_MUTEXED_ACQUIRE(...)            LLH_MUTEXED_TSA(acquire_capability(__VA_ARGS__))
+#define LLH_MUTEXED_ACQUIRE_SHARED(...)     LLH_MUTEXED_TSA(acquire_shared_capability(__VA_ARGS__))
+#define LLH_MUTEXED_RELEASE(...)            LLH_MUTEXED_TSA(release_capability(__VA_ARGS__))
+#define LLH_MUTEXED_RELEASE_SHARED(...)     LLH_MUTEXED_TSA(release_shared_capability(__VA_ARGS__))
+#define LLH_MUTEXED_TRY_ACQUIRE(...)        LLH_MUTEXED_TSA(try_acquire_capability(__VA_ARGS__))
+#define LLH_MUTEXED_TRY_ACQUIRE_SHARED(...) LLH_MUTEXED_TSA(try_acquire_shared_capability(__VA_ARGS__))
+#define LLH_MUTEXED_EXCLUDES(...)           LLH_MUTEXED_TSA(locks_excluded(__VA_ARGS__))
+#define LLH_MUTEXED_NO_THREAD_SAFETY_ANALYSIS LLH_MUTEXED_TSA(no_thread_safety_analysis)
+
+/* The Linux USDT probes of the provider `llh_mutexed` at the lock, wait and
+   notify sites of Mutexed and with_all_locked(), and in usdt_tracer. They are
+   only compiled in when LLH_MUTEXED_USDT is defined and <sys/sdt.h> is
+   available, and expand to nothing otherwise.
+ */
+#if defined(LLH_MUTEXED_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define LLH_MUTEXED_USDT_ENABLED 1
+#endif
+#endif
+
+#ifdef LLH_MUTEXED_USDT_ENABLED
+#define LLH_MUTEXED_USDT_PROBE(name, m, mode) \
+    DTRACE_PROBE2(llh_mutexed, name, static_cast<void const*>(m), static_cast<int>(mode))
+#define LLH_MUTEXED_USDT_PROBE1(name, m) DTRACE_PROBE1(llh_mutexed, name, static_cast<void const*>(m))
+#define LLH_MUTEXED_USDT_NOTIFY(m) LLH_MUTEXED_USDT_PROBE1(notify, m)
+// A try-lock that succeeded, or a change of mode that does not wait : fires both acquire probes.
+#define LLH_MUTEXED_USDT_ACQUIRED(m, mode) do { \
+        LLH_MUTEXED_USDT_PROBE(acquire_begin, m, mode); \
+        LLH_MUTEXED_USDT_PROBE(acquire_end, m, mode); \
+    } while (false)
+// Declared right before a lock guard : fires acquire_begin, then release once the guard has unlocked.
+#define LLH_MUTEXED_USDT_LOCK_SCOPE(m, mode) \
+    ::llh::mutexed::details::usdt_lock_scope const llh_mutexed_usdt_scope_(m, mode)
+// Right after that lock guard : fires acquire_end.
+#define LLH_MUTEXED_USDT_LOCKED() llh_mutexed_usdt_scope_.acquired()
+// Same as LLH_MUTEXED_USDT_LOCK_SCOPE() before a try-lock guard, which fires nothing yet.
+#define LLH_MUTEXED_USDT_TRY_LOCK_SCOPE(m, mode) \
+    ::llh::mutexed::details::usdt_lock_scope const llh_mutexed_usdt_scope_(m, mode, ::llh::mutexed::details::usdt_try_lock)
+// Right after that guard : fires both acquire probes if @a locked.
+#define LLH_MUTEXED_USDT_TRIED(locked) llh_mutexed_usdt_scope_.tried(locked)
+#else
+#define LLH_MUTEXED_USDT_PROBE(name, m, mode)
+#define LLH_MUTEXED_USDT_PROBE1(name, m)
+#define LLH_MUTEXED_USDT_NOTIFY(m)
+#define LLH_MUTEXED_USDT_ACQUIRED(m, mode)
+#define LLH_MUTEXED_USDT_LOCK_SCOPE(m, mode)
+#define LLH_MUTEXED_USDT_LOCKED()
+#define LLH_MUTEXED_USDT_TRY_LOCK_SCOPE(m, mode)
+#define LLH_MUTEXED_USDT_TRIED(locked)
+#endif
 
 namespace llh::mutexed {
 
@@ -23,6 +98,38 @@ concept shared_lockable = requires(M& m) {
     { m.try_lock_shared() } -> std::same_as<bool>;
 };
 
+//! Checks if M has the member functions of a timed mutex.
+template<typename M>
+concept timed_lockable = requires(M& m, std::chrono::milliseconds d, std::chrono::steady_clock::time_point t) {
+    { m.try_lock_for(d) } -> std::same_as<bool>;
+    { m.try_lock_until(t) } -> std::same_as<bool>;
+};
+
+//! Checks if M has the member functions of a shared timed mutex.
+template<typename M>
+concept shared_timed_lockable = shared_lockable<M> && timed_lockable<M> &&
+    requires(M& m, std::chrono::milliseconds d, std::chrono::steady_clock::time_point t) {
+        { m.try_lock_shared_for(d) } -> std::same_as<bool>;
+        { m.try_lock_shared_until(t) } -> std::same_as<bool>;
+    };
+
+//! Checks if M is a shared mutex that also has an upgrade ownership, which
+//! coexists with the shared ones and can become exclusive without being released,
+//! with the member functions of upgrade_mutex.
+template<typename M>
+concept upgrade_lockable = shared_lockable<M> && requires(M& m) {
+    m.lock_upgrade();
+    m.unlock_upgrade();
+    m.unlock_upgrade_and_lock();
+};
+
+//! Checks if M is a shared mutex whose exclusive ownership can become a shared
+//! one without being released, with `unlock_and_lock_shared()` like upgrade_mutex.
+template<typename M>
+concept downgradable = shared_lockable<M> && requires(M& m) {
+    m.unlock_and_lock_shared();
+};
+
 
 //! A tag type to use as last template argument of Mutexed to enable the *waiting API* but making it handle a **condition-variable**.
 struct has_cv {};
@@ -30,6 +137,38 @@ struct has_cv {};
 //! The default last template argument of Mutexed, disabling the *waiting API* but not pay its costs.
 struct no_cv {};
 
+//! A tag type to use as fourth template argument of Mutexed to enable get_snapshot().
+struct has_snapshot {};
+
+//! The default fourth template argument of Mutexed, disabling get_snapshot() and its costs.
+struct no_snapshot {};
+
+//! Disambiguation tag type making with_all_locked acquire the mutexes with
+//! `std::lock()`, whose algorithm locks one mutex and tries to lock the others,
+//! backing off and starting over from the one that failed when one of them is busy.
+struct backoff_locking_t {};
+
+//! Disambiguation tag type making with_all_locked acquire the mutexes one at a
+//! time and without retries, in the order of the addresses of their Mutexed.
+//! Every thread waiting on a mutex holds only mutexes that come before it,
+//! which is what prevents deadlocks.
+struct ordered_locking_t {};
+
+#ifdef LLH_MUTEXED_ORDERED_LOCKING_BY_DEFAULT
+//! The acquisition strategy of with_all_locked when none is provided.
+using default_locking_t = ordered_locking_t;
+#else
+//! The acquisition strategy of with_all_locked when none is provided.
+//! Defining `LLH_MUTEXED_ORDERED_LOCKING_BY_DEFAULT` makes it ordered_locking_t.
+using default_locking_t = backoff_locking_t;
+#endif
+
+//! Checks if @a L is one of the acquisition strategies of with_all_locked.
+template<typename L>
+concept locking_strategy =
+    std::is_same_v<std::decay_t<L>, backoff_locking_t> ||
+    std::is_same_v<std::decay_t<L>, ordered_locking_t>;
+
 //! Checks if @a Tag is in @a Ts
 template<typename Tag, typename... Ts>
 constexpr bool contains_tag() {
@@ -41,8 +180,153 @@ template<typename Tag, typename... Ts>
 concept does_not_contain_tag = !contains_tag<Tag, Ts...>();
 
 
+//! The way a mutex is acquired, as reported to the tracing policies.
+enum class lock_mode { exclusive, shared };
+
+/** The base of the tracing policies of traced_mutex, whose hooks do nothing.
+ *
+ * A tracing policy derives from it and hides the hooks it is interested in
+ * with static member functions of the same signature. Every hook receives the
+ * address of the traced_mutex, which identifies its Mutexed.
+ */
+struct tracing_policy {
+    //! Called before trying to acquire the mutex.
+    static void acquire_begin(void const*, lock_mode) noexcept {}
+    //! Called when the mutex could not be acquired right away.
+    static void contended(void const*, lock_mode) noexcept {}
+    //! Called once the mutex has been acquired.
+    static void acquire_end(void const*, lock_mode) noexcept {}
+    //! Called after the mutex has been released.
+    static void release(void const*, lock_mode) noexcept {}
+    //! Called after the @a condition-variable of a Mutexed has been notified.
+    static void notify(void const*) noexcept {}
+    //! Called when a waiting function of a Mutexed starts waiting.
+    static void wait_begin(void const*, lock_mode) noexcept {}
+    //! Called when a waiting function of a Mutexed returns.
+    static void wait_end(void const*, lock_mode) noexcept {}
+};
+
+/** A mutex that forwards to a mutex of type @a M while calling the hooks of
+ *  the tracing policy @a Tracer.
+ *
+ * Using it as the <em>inner mutex</em> of a Mutexed traces every access to it,
+ * the notifications and waits included :
+ * ```cpp
+ * llh::mutexed::Mutexed<int, llh::mutexed::traced_mutex<std::mutex, my_tracer>, has_cv> traced;
+ * ```
+ * The lock functions try to lock first in order to report contention, and
+ * the shared functions are only available when @a M is
+ * @link llh::mutexed::shared_lockable shared_lockable @endlink.
+ * Since it is not a `std::mutex`, a Mutexed that has_cv holds a
+ * `std::condition_variable_any` for it.
+ */
+template<typename M, typename Tracer>
+requires std::is_base_of_v<tracing_policy, Tracer>
+class LLH_MUTEXED_CAPABILITY("mutex") traced_mutex {
+private:
+    M mtx_;
+
+    template<typename TryLock, typename Lock>
+    void traced_lock(lock_mode mode, TryLock&& try_lock, Lock&& lock) {
+        Tracer::acquire_begin(this, mode);
+        if (!try_lock()) {
+            Tracer::contended(this, mode);
+            lock();
+        }
+        Tracer::acquire_end(this, mode);
+    }
+
+    bool traced_try_lock(lock_mode mode, bool locked) {
+        if (locked) {
+            Tracer::acquire_begin(this, mode);
+            Tracer::acquire_end(this, mode);
+        } else {
+            Tracer::contended(this, mode);
+        }
+        return locked;
+    }
+
+public:
+    //! The type of the traced mutex.
+    using mutex_type = M;
+    //! The tracing policy.
+    using tracer_type = Tracer;
+
+    //! Forwards the arguments to the constructor of the traced mutex.
+    template<typename... Args>
+    explicit traced_mutex(Args&&... args) : mtx_(std::forward<Args>(args)...) {}
+
+    void lock() LLH_MUTEXED_ACQUIRE() LLH_MUTEXED_NO_THREAD_SAFETY_ANALYSIS {
+        traced_lock(lock_mode::exclusive, [this]{ return mtx_.try_lock(); }, [this]{ mtx_.lock(); });
+    }
+    bool try_lock() LLH_MUTEXED_TRY_ACQUIRE(true) LLH_MUTEXED_NO_THREAD_SAFETY_ANALYSIS {
+        return traced_try_lock(lock_mode::exclusive, mtx_.try_lock());
+    }
+    void unlock() LLH_MUTEXED_RELEASE() LLH_MUTEXED_NO_THREAD_SAFETY_ANALYSIS {
+        mtx_.unlock();
+        Tracer::release(this, lock_mode::exclusive);
+    }
+
+    // The attributes come first because they cannot follow a requires-clause.
+    LLH_MUTEXED_ACQUIRE_SHARED() LLH_MUTEXED_NO_THREAD_SAFETY_ANALYSIS
+    void lock_shared() requires shared_lockable<M> {
+        traced_lock(lock_mode::shared, [this]{ return mtx_.try_lock_shared(); }, [this]{ mtx_.lock_shared(); });
+    }
+    LLH_MUTEXED_TRY_ACQUIRE_SHARED(true) LLH_MUTEXED_NO_THREAD_SAFETY_ANALYSIS
+    bool try_lock_shared() requires shared_lockable<M> {
+        return traced_try_lock(lock_mode::shared, mtx_.try_lock_shared());
+    }
+    LLH_MUTEXED_RELEASE_SHARED() LLH_MUTEXED_NO_THREAD_SAFETY_ANALYSIS
+    void unlock_shared() requires shared_lockable<M> {
+        mtx_.unlock_shared();
+        Tracer::release(this, lock_mode::shared);
+    }
+};
+
+
 namespace details {
 
+#ifdef LLH_MUTEXED_USDT_ENABLED
+struct usdt_try_lock_t {};
+inline constexpr usdt_try_lock_t usdt_try_lock{};
+
+//! The probes of a lock site, see LLH_MUTEXED_USDT_LOCK_SCOPE.
+class usdt_lock_scope {
+private:
+    void const* mutexed_;
+    lock_mode mode_;
+    bool mutable locked_ = false;
+
+public:
+    usdt_lock_scope(void const* mutexed, lock_mode mode) noexcept : mutexed_(mutexed), mode_(mode) {
+        LLH_MUTEXED_USDT_PROBE(acquire_begin, mutexed_, mode_);
+    }
+
+    usdt_lock_scope(void const* mutexed, lock_mode mode, usdt_try_lock_t) noexcept : mutexed_(mutexed), mode_(mode) {}
+
+    void acquired() const noexcept {
+        locked_ = true;
+        LLH_MUTEXED_USDT_PROBE(acquire_end, mutexed_, mode_);
+    }
+
+    void tried(bool locked) const noexcept {
+        if (locked) {
+            LLH_MUTEXED_USDT_PROBE(acquire_begin, mutexed_, mode_);
+            acquired();
+        }
+    }
+
+    ~usdt_lock_scope() {
+        if (locked_) {
+            LLH_MUTEXED_USDT_PROBE(release, mutexed_, mode_);
+        }
+    }
+
+    usdt_lock_scope(usdt_lock_scope const&) = delete;
+    usdt_lock_scope& operator=(usdt_lock_scope const&) = delete;
+};
+#endif
+
 //! A tag for identifying Mutexed classes.
 struct mutexed_tag {};
 
@@ -61,6 +345,171 @@ template<typename T>
 using decay_through_ref_wrap_t = typename decay_through_ref_wrap<T>::type;
 
 
+template<typename R>
+struct unwrap_ref {
+    using type = R;
+};
+
+template<typename R>
+struct unwrap_ref<std::reference_wrapper<R>> {
+    using type = R;
+};
+
+//! The type of the elements of the range @a R, or of the range referred to by
+//! the `std::reference_wrapper` @a R, seen through their `std::reference_wrapper`s.
+template<typename R>
+using range_element_t = typename unwrap_ref<std::remove_cvref_t<
+    std::ranges::range_reference_t<typename unwrap_ref<std::remove_cvref_t<R>>::type const&>>>::type;
+
+//! Checks if @a R is a range of Mutexed, or a `std::reference_wrapper` to one, or a range of `std::reference_wrapper`s to Mutexed.
+template<typename R>
+concept mutexed_range =
+    std::ranges::forward_range<typename unwrap_ref<std::remove_cvref_t<R>>::type> &&
+    std::is_base_of_v<mutexed_tag, std::remove_cv_t<range_element_t<R>>>;
+
+//! Checks if M is a traced_mutex, or any mutex exposing a tracing policy.
+template<typename M>
+concept traced = requires { typename M::tracer_type; };
+
+/* The hooks that only a Mutexed knows when to call, which are no-ops unless
+   its inner mutex is traced.
+ */
+template<typename M>
+void trace_notify(M const&) noexcept {}
+
+template<traced M>
+void trace_notify(M const& m) noexcept { M::tracer_type::notify(&m); }
+
+template<typename M>
+void trace_wait_begin(M const&, lock_mode) noexcept {}
+
+template<traced M>
+void trace_wait_begin(M const& m, lock_mode mode) noexcept { M::tracer_type::wait_begin(&m, mode); }
+
+template<typename M>
+void trace_wait_end(M const&, lock_mode) noexcept {}
+
+template<traced M>
+void trace_wait_end(M const& m, lock_mode mode) noexcept { M::tracer_type::wait_end(&m, mode); }
+
+
+//! The result of the functions that may not call their functor : whether it
+//! was called if it returns `void`, an optional of its decayed result otherwise.
+template<typename R>
+using try_result_t = std::conditional_t<std::is_void_v<R>, bool, std::optional<std::decay_t<R>>>;
+
+//! Calls f with the pointed value unless @a val is null.
+template<typename F, typename V>
+auto invoke_if(V* val, F&& f) -> try_result_t<std::invoke_result_t<F, V&>> {
+    if (!val) {
+        return {};
+    }
+    if constexpr (std::is_void_v<std::invoke_result_t<F, V&>>) {
+        std::invoke(std::forward<F>(f), *val);
+        return true;
+    } else {
+        return std::invoke(std::forward<F>(f), *val);
+    }
+}
+
+
+/* A buffer of at most `capacity` trivial values, set at construction, that
+   only allocates when that capacity exceeds N.
+ */
+template<typename T, std::size_t N>
+class small_buffer {
+    static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>);
+
+private:
+    alignas(T) std::byte inline_[N * sizeof(T)];
+    std::unique_ptr<std::byte[]> heap_;
+    T* data_;
+    std::size_t size_ = 0;
+
+public:
+    explicit small_buffer(std::size_t capacity) :
+        heap_(capacity > N ? new std::byte[capacity * sizeof(T)] : nullptr),
+        data_(reinterpret_cast<T*>(heap_ ? heap_.get() : inline_))
+    {}
+
+    small_buffer(small_buffer const&) = delete;
+    small_buffer& operator=(small_buffer const&) = delete;
+
+    void push_back(T const& value) { std::construct_at(data_ + size_++, value); }
+    void resize_down(std::size_t size) { size_ = size; }
+
+    T* begin() { return data_; }
+    T* end() { return data_ + size_; }
+    T* data() { return data_; }
+    std::size_t size() const { return size_; }
+};
+
+/* Locks the provided lockables one at a time, in the order of the addresses
+   returned by their `key()`, and unlocks them in the reverse order on destruction.
+   Like with std::lock(), providing the same Mutexed twice is a deadlock.
+ */
+template<typename... L>
+class ordered_lock {
+private:
+    std::tuple<L&...> lockables_;
+    std::array<std::size_t, sizeof...(L)> order_;
+
+    // Calls f with the i-th lockable.
+    template<typename F>
+    void visit(std::size_t i, F&& f) {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((i == I ? f(std::get<I>(lockables_)) : void()), ...);
+        }(std::index_sequence_for<L...>{});
+    }
+
+    void unlock_first(std::size_t nb) {
+        while (nb > 0) {
+            visit(order_[--nb], [](auto& l) { l.unlock(); });
+        }
+    }
+
+public:
+    explicit ordered_lock(L&... lockables) : lockables_(lockables...) {
+        std::array<void const*, sizeof...(L)> const keys{lockables.key()...};
+        std::iota(order_.begin(), order_.end(), std::size_t(0));
+        std::sort(order_.begin(), order_.end(), [&keys](std::size_t a, std::size_t b) {
+            return std::less<void const*>{}(keys[a], keys[b]);
+        });
+
+        std::size_t nb_locked = 0;
+        try {
+            for (; nb_locked < order_.size(); ++nb_locked) {
+                visit(order_[nb_locked], [](auto& l) { l.lock(); });
+            }
+        } catch (...) {
+            unlock_first(nb_locked);
+            throw;
+        }
+    }
+
+    ~ordered_lock() {
+        unlock_first(order_.size());
+    }
+
+    ordered_lock(ordered_lock const&) = delete;
+    ordered_lock& operator=(ordered_lock const&) = delete;
+};
+
+//! The lock guard implementing an acquisition strategy.
+template<typename Locking, typename... L>
+struct locking_guard;
+
+template<typename... L>
+struct locking_guard<backoff_locking_t, L...> {
+    using type = std::scoped_lock<L...>;
+};
+
+template<typename... L>
+struct locking_guard<ordered_locking_t, L...> {
+    using type = ordered_lock<L...>;
+};
+
+
 /* Functor that locks all provided Mutexed for the duration of a provided function.
    It was implemented this way instead of a being directly a free function because it needs
    access to the private members of Mutexed, and writing `friend details::all_locker`
@@ -69,15 +518,46 @@ using decay_through_ref_wrap_t = typename decay_through_ref_wrap<T>::type;
 struct all_locker {
     // This specialization simply forwards the calls to the `lock()` functions
     // to the inner mutex of the held `Mutexed&`.
+    // The proxies are not capabilities, since the analysis cannot follow the
+    // locks taken through them by std::lock() and the range form. Their members
+    // are not analysed either, as they leave the inner mutex locked or unlocked.
     template<typename M>
     struct lockable_proxy {
         M& m;
 
-        void lock() { m.mtx_.lock(); }
-        void unlock() { m.mtx_.unlock(); }
-        bool try_lock() { return m.mtx_.try_lock(); }
+        void lock() LLH_MUTEXED_NO_THREAD_SAFETY_ANALYSIS {
+            LLH_MUTEXED_USDT_PROBE(acquire_begin, &m, lock_mode::exclusive);
+            m.mtx_.lock();
+            LLH_MUTEXED_USDT_PROBE(acquire_end, &m, lock_mode::exclusive);
+            on_write_lock();
+        }
+        void unlock() LLH_MUTEXED_NO_THREAD_SAFETY_ANALYSIS {
+            m.mtx_.unlock();
+            LLH_MUTEXED_USDT_PROBE(release, &m, lock_mode::exclusive);
+        }
+        bool try_lock() LLH_MUTEXED_NO_THREAD_SAFETY_ANALYSIS {
+            bool const locked = m.mtx_.try_lock();
+            if (locked) {
+                LLH_MUTEXED_USDT_ACQUIRED(&m, lock_mode::exclusive);
+                on_write_lock();
+            }
+            return locked;
+        }
 
+        void const* key() const { return &m; }
         auto& inner_val_ref() { return m.val_; }
+        // A const M is locked exclusively when its mutex is not shared_lockable, which is no write.
+        void on_write_lock() const {
+            if constexpr (!std::is_const_v<M>) {
+                m.invalidate_snapshot();
+            }
+        }
+        // Only a write-access notifies, which a const M cannot be.
+        void notify() const {
+            if constexpr (!std::is_const_v<M>) {
+                m.notify_waiters();
+            }
+        }
     };
 
     /* This specialization calls the `lock_shared()` functions on the inner mutex
@@ -93,19 +573,225 @@ struct all_locker {
 
         explicit lockable_proxy(M const& c_m) : m(const_cast<M&>(c_m)) {}
 
-        void lock() { m.mtx_.lock_shared(); }
-        void unlock() { m.mtx_.unlock_shared(); }
-        bool try_lock() { return m.mtx_.try_lock_shared(); }
+        void lock() LLH_MUTEXED_NO_THREAD_SAFETY_ANALYSIS {
+            LLH_MUTEXED_USDT_PROBE(acquire_begin, &m, lock_mode::shared);
+            m.mtx_.lock_shared();
+            LLH_MUTEXED_USDT_PROBE(acquire_end, &m, lock_mode::shared);
+        }
+        void unlock() LLH_MUTEXED_NO_THREAD_SAFETY_ANALYSIS {
+            m.mtx_.unlock_shared();
+            LLH_MUTEXED_USDT_PROBE(release, &m, lock_mode::shared);
+        }
+        bool try_lock() LLH_MUTEXED_NO_THREAD_SAFETY_ANALYSIS {
+            bool const locked = m.mtx_.try_lock_shared();
+            if (locked) {
+                LLH_MUTEXED_USDT_ACQUIRED(&m, lock_mode::shared);
+            }
+            return locked;
+        }
 
+        void const* key() const { return &m; }
         auto const& inner_val_ref() { return m.val_; }
+        void notify() const {}
     };
 
     template<typename M> lockable_proxy(std::reference_wrapper<M>) -> lockable_proxy<M>;
     template<typename M> lockable_proxy(M&) -> lockable_proxy<M>;
 
+    // Notifies on destruction the Mutexed of the provided proxies that were
+    // write-accessed, which is why it must be declared before their lock guard.
+    template<typename... P>
+    struct deferred_notify {
+        std::tuple<P const&...> proxies;
+
+        ~deferred_notify() { std::apply([](P const&... p) { (p.notify(), ...); }, proxies); }
+    };
+
+    // A lock of a Mutexed from a range, whose type is erased so that ranges of
+    // different types of Mutexed can be sorted together.
+    struct range_entry {
+        void const* key;
+        void (*lock)(void const*);
+        void (*unlock)(void const*);
+        void (*notify)(void const*);
+        // Whether the Mutexed is accessed as mutable, which locks it exclusively
+        // whatever its mutex, and invalidates its snapshot and notifies it.
+        bool write;
+    };
+
+    // The number of Mutexed from ranges that can be locked without allocating.
+    static constexpr std::size_t range_inline_capacity = 16;
+
+    template<typename R>
+    static auto& unwrap(R& r) { return r; }
+
+    template<typename R>
+    static R& unwrap(std::reference_wrapper<R> r) { return r.get(); }
+
+    // The Mutexed type of the elements of a range, const if they are.
+    template<typename R>
+    using range_mutexed_t = std::remove_reference_t<decltype(unwrap(*std::ranges::begin(unwrap(std::declval<R&>()))))>;
+
+    // The type of the values of the Mutexed of a range, const if they are.
+    template<typename R, typename MX = range_mutexed_t<R>>
+    using range_value_t = std::conditional_t<
+        std::is_const_v<MX>,
+        typename std::remove_const_t<MX>::value_type const,
+        typename MX::value_type
+    >;
+
+    template<typename MX>
+    static range_entry make_range_entry(MX& m) {
+        return range_entry{
+            &m,
+            [](void const* p) { lockable_proxy<MX>{*static_cast<MX*>(const_cast<void*>(p))}.lock(); },
+            [](void const* p) { lockable_proxy<MX>{*static_cast<MX*>(const_cast<void*>(p))}.unlock(); },
+            [](void const* p) { lockable_proxy<MX>{*static_cast<MX*>(const_cast<void*>(p))}.notify(); },
+            !std::is_const_v<MX>
+        };
+    }
+
+    // Locks the sorted entries in order and unlocks them in the reverse order on destruction.
+    template<typename Entries>
+    struct range_lock {
+        Entries& entries;
+        std::size_t nb_locked = 0;
+
+        explicit range_lock(Entries& e) : entries(e) {
+            try {
+                for (; nb_locked < entries.size(); ++nb_locked) {
+                    entries.data()[nb_locked].lock(entries.data()[nb_locked].key);
+                }
+            } catch (...) {
+                unlock_all();
+                throw;
+            }
+        }
+
+        ~range_lock() { unlock_all(); }
+
+        void unlock_all() {
+            while (nb_locked > 0) {
+                --nb_locked;
+                entries.data()[nb_locked].unlock(entries.data()[nb_locked].key);
+            }
+        }
+    };
+
+    // The deferred_notify of the sorted entries.
+    template<typename Entries>
+    struct range_notify {
+        Entries& entries;
+
+        ~range_notify() {
+            for (range_entry const& e : entries) {
+                if (e.write) {
+                    e.notify(e.key);
+                }
+            }
+        }
+    };
+
+    /* The lock guard returned by locked_all(). It holds the lockable_proxy s
+       and the guard of the acquisition strategy, after the destruction of which
+       the Mutexed that were write-accessed are notified.
+     */
+    template<typename Locking, typename... P>
+    class all_lock_guard {
+    private:
+        std::tuple<P...> proxies_;
+
+        deferred_notify<P...> notifier_{proxies_};
+
+        typename locking_guard<Locking, P...>::type lock_;
+
+        template<std::size_t... I>
+        all_lock_guard(std::tuple<P...>&& proxies, std::index_sequence<I...>) :
+            proxies_(std::move(proxies)),
+            lock_(std::get<I>(proxies_)...)
+        {}
+
+    public:
+        explicit all_lock_guard(std::tuple<P...>&& proxies) :
+            all_lock_guard(std::move(proxies), std::index_sequence_for<P...>{})
+        {}
+
+        // Copies would mess with unlocks and notifications
+        all_lock_guard(all_lock_guard const&) = delete;
+        // Moves could have use-cases but would require tracking an otherwise useless state
+        all_lock_guard(all_lock_guard&&) = delete;
+    };
+
+    template<typename Locking, typename... M>
+    static auto locked(M&&... mtxs) {
+        return [](auto... mp) {
+            using guard = all_lock_guard<Locking, decltype(mp)...>;
+            return std::tuple<guard, decltype(mp.inner_val_ref())...>(std::tuple(mp...), mp.inner_val_ref()...);
+        }(lockable_proxy{std::forward<M>(mtxs)}...);
+    }
+
     template<typename F, typename... M>
     requires std::conjunction_v<std::is_base_of<mutexed_tag, decay_through_ref_wrap_t<M>>...>
     decltype(auto) operator()(F&& f, M&&... mtxs) const {
+        return (*this)(default_locking_t{}, std::forward<F>(f), std::forward<M>(mtxs)...);
+    }
+
+    /* Locks all the Mutexed of the provided ranges in the order of their
+       addresses, locking only once those that appear several times, as mutable
+       if any of their occurrences is, and calls f with a span of references to
+       the values of each range. Those accessed as mutable are notified after
+       all of them have been unlocked.
+     */
+    template<typename F, typename... R>
+    requires (sizeof...(R) > 0) && (mutexed_range<R> && ...)
+    decltype(auto) operator()(F&& f, R&&... ranges) const {
+        std::size_t const total = (static_cast<std::size_t>(std::ranges::distance(unwrap(ranges))) + ...);
+        small_buffer<range_entry, range_inline_capacity> entries(total);
+        ([&] {
+            for (auto&& m : unwrap(ranges)) {
+                entries.push_back(make_range_entry(unwrap(m)));
+            }
+        }(), ...);
+
+        /* Sorting the mutable accesses first so that they are the ones kept for
+           duplicates, whose functions then lock exclusively and notify. The
+           kind of lock cannot tell them apart, since a const access to a
+           Mutexed whose mutex is not shared_lockable locks it exclusively too.
+         */
+        std::sort(entries.begin(), entries.end(), [](range_entry const& a, range_entry const& b) {
+            std::less<void const*> less;
+            return less(a.key, b.key) || (a.key == b.key && a.write && !b.write);
+        });
+        std::size_t nb_unique = 0;
+        for (range_entry const& e : entries) {
+            if (nb_unique > 0 && entries.data()[nb_unique - 1].key == e.key) {
+                entries.data()[nb_unique - 1].write |= e.write;
+            } else {
+                entries.data()[nb_unique++] = e;
+            }
+        }
+        entries.resize_down(nb_unique);
+
+        std::tuple<small_buffer<std::reference_wrapper<range_value_t<R>>, range_inline_capacity>...> refs(
+            static_cast<std::size_t>(std::ranges::distance(unwrap(ranges)))...);
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ([&] {
+                for (auto&& m : unwrap(ranges)) {
+                    std::get<I>(refs).push_back(std::ref(unwrap(m).val_));
+                }
+            }(), ...);
+        }(std::index_sequence_for<R...>{});
+
+        range_notify notify{entries};
+        range_lock lock(entries);
+        return std::apply([&f](auto&... r) {
+            return std::invoke(std::forward<F>(f), std::span(r.data(), r.size())...);
+        }, refs);
+    }
+
+    template<locking_strategy Locking, typename F, typename... M>
+    requires std::conjunction_v<std::is_base_of<mutexed_tag, decay_through_ref_wrap_t<M>>...>
+    decltype(auto) operator()(Locking, F&& f, M&&... mtxs) const {
         /* If we just invoke f, only lock() or try_lock() will be called on the mutexes.
            Instead, we create a lockable_proxy of the Mutexed s that will dispatch the
            calls made by std::lock() to their shared counterparts when it is suitable.
@@ -115,31 +801,251 @@ struct all_locker {
            instantly called.
          */
         return [](auto&& f, auto&&... mp) {
-            std::scoped_lock<std::decay_t<decltype(mp)>...> lock(mp...);
+            deferred_notify<std::decay_t<decltype(mp)>...> notify{{mp...}};
+            typename locking_guard<std::decay_t<Locking>, std::decay_t<decltype(mp)>...>::type lock(mp...);
             return std::invoke(std::forward<F>(f), mp.inner_val_ref()...);
         }(std::forward<F>(f), lockable_proxy{std::forward<M>(mtxs)}...);
     }
 };
 
+/* Functor that calls a function with all provided Mutexed locked if `std::try_lock()`
+   can lock them right away, with the lockable_proxy s of all_locker.
+ */
+struct all_try_locker {
+    template<typename F, typename... M>
+    requires (sizeof...(M) > 0) &&
+        std::conjunction_v<std::is_base_of<mutexed_tag, decay_through_ref_wrap_t<M>>...>
+    auto operator()(F&& f, M&&... mtxs) const {
+        return [](auto&& f, auto... mp) -> try_result_t<std::invoke_result_t<F, decltype(mp.inner_val_ref())...>> {
+            // std::try_lock() needs at least two lockables.
+            bool const locked = [&mp...] {
+                if constexpr (sizeof...(mp) == 1) {
+                    return (mp.try_lock() && ...);
+                } else {
+                    return std::try_lock(mp...) == -1;
+                }
+            }();
+            if (!locked) {
+                return {};
+            }
+            // Declared first so that the notifications happen after the unlocks.
+            all_locker::deferred_notify<decltype(mp)...> notify{{mp...}};
+            std::scoped_lock lock(std::adopt_lock, mp...);
+            if constexpr (std::is_void_v<std::invoke_result_t<F, decltype(mp.inner_val_ref())...>>) {
+                std::invoke(std::forward<F>(f), mp.inner_val_ref()...);
+                return true;
+            } else {
+                return std::invoke(std::forward<F>(f), mp.inner_val_ref()...);
+            }
+        }(std::forward<F>(f), all_locker::lockable_proxy{std::forward<M>(mtxs)}...);
+    }
+};
+
+
+//! A thread blocked in wait_any() or wait_all(), signaled by any of the Mutexed it waits on.
+struct external_waiter {
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool signaled = false;
+
+    void signal() {
+        {
+            std::lock_guard lock(mtx);
+            signaled = true;
+        }
+        cv.notify_one();
+    }
+};
+
+//! The registration of an external_waiter in the intrusive list of one Mutexed.
+struct waiter_node {
+    external_waiter* waiter = nullptr;
+    waiter_node* prev = nullptr;
+    waiter_node* next = nullptr;
+};
+
+/* The external waiters of a Mutexed that has_cv, signaled along with its
+   condition-variable. Their number is read first so that notifying a Mutexed
+   nobody waits on from wait_any() or wait_all() does not lock anything.
+ */
+struct waiter_registry {
+    std::mutex mutable waiters_mtx_;
+    waiter_node mutable* waiters_ = nullptr;
+    std::atomic<std::size_t> mutable nb_waiters_ = 0;
+
+    void add_waiter(waiter_node& node) const {
+        std::lock_guard lock(waiters_mtx_);
+        node.prev = nullptr;
+        node.next = waiters_;
+        if (waiters_) {
+            waiters_->prev = &node;
+        }
+        waiters_ = &node;
+        nb_waiters_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void remove_waiter(waiter_node& node) const {
+        std::lock_guard lock(waiters_mtx_);
+        (node.prev ? node.prev->next : waiters_) = node.next;
+        if (node.next) {
+            node.next->prev = node.prev;
+        }
+        nb_waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /* The registration happens before the predicates are checked under the
+       inner mutex, and the signal after a write-access has released it, so the
+       mutex orders them and the count cannot be missed.
+     */
+    void signal_waiters() const {
+        if (nb_waiters_.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+        // Holding the list lock prevents the waiters from leaving while being signaled.
+        std::lock_guard lock(waiters_mtx_);
+        for (waiter_node* n = waiters_; n; n = n->next) {
+            n->waiter->signal();
+        }
+    }
+};
 
 /** The base class of Mutexed that handles the possession and type of a condition-variable member. */
 template<typename M, typename H = no_cv>
 struct mutexed_base{};
 
 template<typename M>
-struct mutexed_base<M, has_cv> {
+struct mutexed_base<M, has_cv> : waiter_registry {
     std::condition_variable_any mutable cv_;
 };
 
 //! `std::condition_variable` is faster but only works for `std::mutex`,
 //! so we make a specialization for it.
 template<>
-struct mutexed_base<std::mutex, has_cv> {
+struct mutexed_base<std::mutex, has_cv> : waiter_registry {
     std::condition_variable mutable cv_;
 };
 
+/** The base class of Mutexed that holds the cached snapshot of its value if it has_snapshot. */
+template<typename T, typename S = no_snapshot>
+struct snapshot_base {
+    void invalidate_snapshot() const {}
+};
+
+template<typename T>
+struct snapshot_base<T, has_snapshot> {
+    // Null after every exclusive lock, until get_snapshot() rebuilds it.
+    std::atomic<std::shared_ptr<T const>> mutable snapshot_;
+
+    void invalidate_snapshot() const { snapshot_.store(nullptr, std::memory_order_release); }
+};
+
+/* Functor-like struct implementing wait_any() and wait_all(), a friend of
+   Mutexed for the same reason as all_locker.
+ */
+struct multi_waiter {
+    // Registers a waiter in some Mutexed for the lifetime of the object.
+    template<typename... MX>
+    struct registration {
+        std::tuple<MX const&...> mtxs;
+        std::array<waiter_node, sizeof...(MX)> nodes;
+
+        registration(external_waiter& w, MX const&... m) : mtxs(m...) {
+            std::size_t i = 0;
+            ((nodes[i].waiter = &w, m.add_waiter(nodes[i]), ++i), ...);
+        }
+
+        ~registration() {
+            std::apply([this](MX const&... m) {
+                std::size_t i = 0;
+                (m.remove_waiter(nodes[i++]), ...);
+            }, mtxs);
+        }
+
+        registration(registration const&) = delete;
+        registration& operator=(registration const&) = delete;
+    };
+
+    /* Calls `check()` until it returns a value that converts to `true`, waiting
+       for a write-access to any of the Mutexed between the calls.
+     */
+    template<typename Check, typename... MX>
+    static auto wait(Check&& check, MX const&... mtxs) {
+        external_waiter w;
+        registration<MX...> reg(w, mtxs...);
+        while (true) {
+            {
+                std::lock_guard lock(w.mtx);
+                w.signaled = false;
+            }
+            if (auto result = check()) {
+                return result;
+            }
+            std::unique_lock lock(w.mtx);
+            w.cv.wait(lock, [&w] { return w.signaled; });
+        }
+    }
+
+    // Applies f to the predicates and to the Mutexed of the alternating arguments.
+    template<typename F, typename Args, std::size_t... I>
+    static decltype(auto) split_pairs(F&& f, Args&& args, std::index_sequence<I...>) {
+        return std::forward<F>(f)(std::tie(std::get<2 * I>(args)...), std::get<2 * I + 1>(args)...);
+    }
+
+    template<typename... Args>
+    static std::size_t wait_any(Args&&... args) {
+        return split_pairs([](auto preds, auto const&... mtxs) {
+            // One more than the index, so that the first predicate converts to `true`.
+            std::size_t const one_past = wait([&] {
+                std::size_t found = 0;
+                [&]<std::size_t... I>(std::index_sequence<I...>) {
+                    (void)(... || (static_cast<bool>(mtxs.with_locked(std::get<I>(preds))) && (found = I + 1)));
+                }(std::index_sequence_for<decltype(mtxs)...>{});
+                return found;
+            }, mtxs...);
+            return one_past - 1;
+        }, std::forward_as_tuple(std::forward<Args>(args)...), std::make_index_sequence<sizeof...(Args) / 2>{});
+    }
+
+    template<typename... Args>
+    static void wait_all(Args&&... args) {
+        split_pairs([](auto preds, auto const&... mtxs) {
+            wait([&] {
+                return all_locker{}([&](auto const&... vals) {
+                    return [&]<std::size_t... I>(std::index_sequence<I...>) {
+                        return (static_cast<bool>(std::invoke(std::get<I>(preds), vals)) && ...);
+                    }(std::index_sequence_for<decltype(vals)...>{});
+                }, std::cref(mtxs)...);
+            }, mtxs...);
+        }, std::forward_as_tuple(std::forward<Args>(args)...), std::make_index_sequence<sizeof...(Args) / 2>{});
+    }
+};
+
+//! Checks if @a MX is a Mutexed that can be waited on with the predicate @a P.
+template<typename MX, typename P>
+concept waitable_with = requires(std::remove_reference_t<MX> const& m, P&& p) {
+    m.wait(p);
+};
+
+//! Checks if the arguments alternate predicates and Mutexed that can be waited on with them.
+template<typename... Args>
+constexpr bool are_wait_pairs() {
+    if constexpr (sizeof...(Args) == 0 || sizeof...(Args) % 2 != 0) {
+        return false;
+    } else {
+        using args = std::tuple<Args...>;
+        return []<std::size_t... I>(std::index_sequence<I...>) {
+            return (waitable_with<std::tuple_element_t<2 * I + 1, args>, std::tuple_element_t<2 * I, args>> && ...);
+        }(std::make_index_sequence<sizeof...(Args) / 2>{});
+    }
+}
+
 } // end namespace details
 
+//! Disambiguation tag type making the mutable with_locked() notify only if its functor returns `true`, meaning that it changed the value.
+struct report_change_t{};
+//! Disambiguation tag type making the mutable with_locked() notify only if the value compares unequal to a copy made before calling its functor.
+struct detect_change_t{};
+
 //! Disambiguation tag type used to provide arguments for the in-place construction of the inner mutex.
 struct mutex_args_t{};
 //! Disambiguation tag type used to provide arguments for the in-place construction of the mutexed value.
@@ -157,14 +1063,27 @@ struct value_args_t{};
  * @tparam H option to activate @ref Waiting if it is has_cv.
  *         The default value is no_cv, in which case no @a condition-variable is
  *         held and waiting functions are not available.
+ * @tparam S option to make get_snapshot() available if it is has_snapshot.
+ *         The default value is no_snapshot, in which case no snapshot is held.
+ *
+ * With Clang, a Mutexed is a @a capability for `-Wthread-safety` and its
+ * locking member functions are declared as excluding it, which catches the
+ * self-deadlock of calling them from a function declared as requiring it.
+ * The wrapped value is not declared as guarded, since it is only reachable
+ * through these functions.
  */
-template<typename T, typename M = std::shared_mutex, typename H = no_cv>
-class Mutexed : private details::mutexed_tag, private details::mutexed_base<M, H> {
+template<typename T, typename M = std::shared_mutex, typename H = no_cv, typename S = no_snapshot>
+class LLH_MUTEXED_CAPABILITY("mutexed") Mutexed :
+    private details::mutexed_tag,
+    private details::mutexed_base<M, H>,
+    private details::snapshot_base<T, S>
+{
 private:
     M mutable mtx_;
     T val_;
 
     friend details::all_locker;
+    friend details::multi_waiter;
 
     //! A struct that notifies the **condition-variable** of a Mutexed if it has one.
     //! The default case for the template parameter gives a struct that does nothing.
@@ -177,19 +1096,161 @@ private:
 
     //! This specialization's destructor calls `notify_all()` on a **condition-variable**.
     template<typename HasCV>
-    requires requires(HasCV& m) { m.cv_.notify_all(); }
+    requires std::is_same_v<H, has_cv>
     struct defer_notify<HasCV> {
-        decltype(std::declval<HasCV>().cv_)& cv_;
+        HasCV const& m_;
 
-        explicit defer_notify(HasCV const& m) : cv_(m.cv_) {}
+        explicit defer_notify(HasCV const& m) : m_(m) {}
 
         ~defer_notify() {
-            cv_.notify_all();
+            m_.notify_waiters();
         }
     };
 
     using notifier = defer_notify<Mutexed>;
 
+    //! Notifies on destruction if @a changed is then `true`.
+    struct notify_if_changed {
+        Mutexed const& m;
+        bool const& changed;
+
+        ~notify_if_changed() {
+            if (changed) {
+                m.notify_waiters();
+            }
+        }
+    };
+
+    //! Notifies the <em>inner condition-variable</em> after a write-access, if @ref Waiting is enabled.
+    void notify_waiters() const {
+        if constexpr (std::is_same_v<H, has_cv>) {
+            this->cv_.notify_all();
+            this->signal_waiters();
+            details::trace_notify(mtx_);
+            LLH_MUTEXED_USDT_NOTIFY(this);
+        }
+    }
+
+    //! The mode in which the <em>inner mutex</em> is locked for read-accesses.
+    static constexpr lock_mode read_mode = shared_lockable<M> ? lock_mode::shared : lock_mode::exclusive;
+
+    //! The result of a try-lock of the <em>inner mutex</em>, for the Lock to adopt.
+    struct tried {
+        Mutexed& m;
+        bool locked;
+    };
+
+    //! The lock guard of locked() and try_locked(), which notifies after unlocking.
+    class Lock {
+    private:
+        Mutexed& m;
+        bool owns = true;
+        bool downgraded = false;
+        bool unchanged = false;
+
+        void lock()   LLH_MUTEXED_NO_THREAD_SAFETY_ANALYSIS {
+            LLH_MUTEXED_USDT_PROBE(acquire_begin, &m, lock_mode::exclusive);
+            m.mtx_.lock();
+            LLH_MUTEXED_USDT_PROBE(acquire_end, &m, lock_mode::exclusive);
+            m.invalidate_snapshot();
+        }
+        void unlock() LLH_MUTEXED_NO_THREAD_SAFETY_ANALYSIS {
+            if constexpr (downgradable<M>) {
+                if (downgraded) {
+                    m.mtx_.unlock_shared();
+                    LLH_MUTEXED_USDT_PROBE(release, &m, lock_mode::shared);
+                    return;
+                }
+            }
+            m.mtx_.unlock();
+            LLH_MUTEXED_USDT_PROBE(release, &m, lock_mode::exclusive);
+        }
+
+    public:
+        explicit Lock(Mutexed& mtx) : m(mtx) { lock(); }
+        explicit Lock(tried t) : m(t.m), owns(t.locked) {
+            if (owns) {
+                LLH_MUTEXED_USDT_ACQUIRED(&m, lock_mode::exclusive);
+                m.invalidate_snapshot();
+            }
+        }
+
+        ~Lock() {
+            if (!owns) {
+                return;
+            }
+            unlock();
+            if (!downgraded && !unchanged) {
+                m.notify_waiters();
+            }
+        }
+
+        // Copies would mess with unlocks and notifications
+        Lock(Lock const&) = delete;
+        // Moves could have use-cases but would require tracking an otherwise useless state
+        Lock(Lock &&) = delete;
+
+        //! Whether the <em>inner mutex</em> is locked, which try_locked() may fail to do.
+        explicit operator bool() const { return owns; }
+
+        //! Declares that the value was not changed, so that unlocking does not notify.
+        void mark_unchanged() { unchanged = true; }
+
+        // Turns the exclusive lock into a shared one and notifies right away.
+        // The attributes come first because they cannot follow a requires-clause.
+        LLH_MUTEXED_NO_THREAD_SAFETY_ANALYSIS
+        T const& downgrade() requires downgradable<M> {
+            if (!downgraded) {
+                m.mtx_.unlock_and_lock_shared();
+                LLH_MUTEXED_USDT_PROBE(release, &m, lock_mode::exclusive);
+                LLH_MUTEXED_USDT_ACQUIRED(&m, lock_mode::shared);
+                downgraded = true;
+                m.notify_waiters();
+            }
+            return m.val_;
+        }
+    };
+
+    //! Whether the <em>inner mutex</em> can be locked for a read-access with a timeout.
+    static constexpr bool read_timed_lockable = shared_lockable<M> ? shared_timed_lockable<M> : timed_lockable<M>;
+
+    //! Constructs a possibly_shared_lock with @a args and points to the value if it owns the <em>inner mutex</em>.
+    template<typename... LockArgs>
+    auto read_locked_if(LockArgs const&... args) const {
+        possibly_shared_lock lock(mtx_, args...);
+        T const* val = lock.owns_lock() ? &val_ : nullptr;
+        return std::tuple<possibly_shared_lock, T const*>{std::move(lock), val};
+    }
+
+    //! Same as read_locked_if() for a lock returned to the caller, whose release fires no probe.
+    template<typename... LockArgs>
+    auto read_locked_if_returned(LockArgs const&... args) const {
+        auto locked = read_locked_if(args...);
+        if (std::get<1>(locked)) {
+            LLH_MUTEXED_USDT_ACQUIRED(this, read_mode);
+        }
+        return locked;
+    }
+
+    //! Adopts the result of a try-lock and points to the value if it succeeded.
+    std::tuple<Lock, T*> write_locked_if(bool locked) {
+        return std::tuple<Lock, T*>(tried{*this, locked}, locked ? &val_ : nullptr);
+    }
+
+    //! Reports the beginning and the end of a wait to the tracing policy of the <em>inner mutex</em>, and to the USDT probes.
+    struct traced_wait {
+        Mutexed const& m_;
+
+        explicit traced_wait(Mutexed const& m) : m_(m) {
+            details::trace_wait_begin(m_.mtx_, read_mode);
+            LLH_MUTEXED_USDT_PROBE(wait_begin, &m_, read_mode);
+        }
+        ~traced_wait() {
+            LLH_MUTEXED_USDT_PROBE(wait_end, &m_, read_mode);
+            details::trace_wait_end(m_.mtx_, read_mode);
+        }
+    };
+
 public:
     //! The type of the wrapped value
     using value_type = T;
@@ -199,6 +1260,9 @@ public:
     //! A `std::shared_lock<M>` if Mutexed::mutex_type is @link
     //! llh::mutexed::shared_lockable shared_lockable @endlink, a
     //! `std::unique_lock<M>` otherwise.
+    //! Being a standard type, it only carries thread-safety annotations if the
+    //! standard library provides them (libc++ with
+    //! `_LIBCPP_ENABLE_THREAD_SAFETY_ANNOTATIONS`).
     using possibly_shared_lock = std::conditional_t<
         shared_lockable<M>,
         std::shared_lock<M>,
@@ -212,12 +1276,30 @@ public:
     //! and default-initializes the mutex.
     template<typename... ValueArgs>
     requires does_not_contain_tag<mutex_args_t, ValueArgs...> &&
+        does_not_contain_tag<std::allocator_arg_t, ValueArgs...> &&
         std::is_constructible_v<T, ValueArgs&&...>
     explicit Mutexed(ValueArgs&&... args) : mtx_(), val_(std::forward<ValueArgs>(args)...) {}
 
+    /** Constructs the wrapped value with @a alloc and the provided arguments
+     *  by uses-allocator construction, and default-initializes the mutex.
+     *
+     * This is how `std::pmr` containers get their memory resource :
+     * ```cpp
+     * std::pmr::monotonic_buffer_resource arena;
+     * llh::mutexed::Mutexed<std::pmr::vector<int>> ints(std::allocator_arg, std::pmr::polymorphic_allocator<>(&arena));
+     * ```
+     */
+    template<typename Alloc, typename... ValueArgs>
+    requires std::uses_allocator_v<T, Alloc>
+    explicit Mutexed(std::allocator_arg_t, Alloc const& alloc, ValueArgs&&... args) :
+        mtx_(),
+        val_(std::make_obj_using_allocator<T>(alloc, std::forward<ValueArgs>(args)...))
+    {}
+
     //! Forwards the first argument to the constructor of the value and
     //! the second argument to the constructor of the mutex.
     template<typename ValArg, typename MutexArg>
+    requires does_not_contain_tag<std::allocator_arg_t, ValArg>
     explicit Mutexed(ValArg&& v_arg, MutexArg&& m_arg) :
         mtx_(std::forward<MutexArg>(m_arg)),
         val_(std::forward<ValArg>(v_arg))
@@ -267,8 +1349,10 @@ public:
     requires
         invokable_with<F, T const&> ||
         invokable_with<F, T> && std::is_copy_constructible_v<T>
-    decltype(auto) with_locked(F&& f) const {
+    decltype(auto) with_locked(F&& f) const LLH_MUTEXED_EXCLUDES(this) {
+        LLH_MUTEXED_USDT_LOCK_SCOPE(this, read_mode);
         possibly_shared_lock lock(mtx_);
+        LLH_MUTEXED_USDT_LOCKED();
         return std::invoke(std::forward<F>(f), val_);
     }
 
@@ -294,21 +1378,549 @@ public:
      */
     template<typename F>
     requires invokable_with<F, T&>
-    decltype(auto) with_locked(F&& f) {
+    decltype(auto) with_locked(F&& f) LLH_MUTEXED_EXCLUDES(this) {
         notifier dn(*this);
+        LLH_MUTEXED_USDT_LOCK_SCOPE(this, lock_mode::exclusive);
         std::lock_guard lock(mtx_);
+        LLH_MUTEXED_USDT_LOCKED();
+        this->invalidate_snapshot();
         return std::invoke(f, val_);
     }
 
+    /** The handle that with_upgradeable_locked() provides to its functor.
+     *
+     * It gives `const` access to the wrapped value while the <em>inner
+     * mutex</em> is upgrade-locked, and mutable access once upgrade() has
+     * turned that lock into an exclusive one.
+     */
+    class upgradeable_access {
+    private:
+        Mutexed& m_;
+        bool upgraded_ = false;
+
+        friend Mutexed;
+
+        // The upgrade lock is reported as shared, since it lets the readers in.
+        explicit upgradeable_access(Mutexed& m) : m_(m) {
+            LLH_MUTEXED_USDT_PROBE(acquire_begin, &m_, lock_mode::shared);
+            m_.mtx_.lock_upgrade();
+            LLH_MUTEXED_USDT_PROBE(acquire_end, &m_, lock_mode::shared);
+        }
+
+        ~upgradeable_access() {
+            if (upgraded_) {
+                m_.mtx_.unlock();
+                LLH_MUTEXED_USDT_PROBE(release, &m_, lock_mode::exclusive);
+                m_.notify_waiters();
+            } else {
+                m_.mtx_.unlock_upgrade();
+                LLH_MUTEXED_USDT_PROBE(release, &m_, lock_mode::shared);
+            }
+        }
+
+    public:
+        upgradeable_access(upgradeable_access const&) = delete;
+        upgradeable_access& operator=(upgradeable_access const&) = delete;
+
+        T const& operator*() const { return m_.val_; }
+        T const* operator->() const { return &m_.val_; }
+
+        //! Waits for the readers to leave, if it has not been done yet, and
+        //! returns a mutable reference to the wrapped value.
+        T& upgrade() {
+            if (!upgraded_) {
+                LLH_MUTEXED_USDT_PROBE(release, &m_, lock_mode::shared);
+                LLH_MUTEXED_USDT_PROBE(acquire_begin, &m_, lock_mode::exclusive);
+                m_.mtx_.unlock_upgrade_and_lock();
+                LLH_MUTEXED_USDT_PROBE(acquire_end, &m_, lock_mode::exclusive);
+                m_.invalidate_snapshot();
+                upgraded_ = true;
+            }
+            return m_.val_;
+        }
+
+        //! Whether upgrade() has been called.
+        bool upgraded() const { return upgraded_; }
+    };
+
+    /** Calls @a f with an upgradeable_access to the wrapped value while
+     *  upgrade-locking the <em>inner mutex</em>.
+     *
+     * The upgrade lock lets the readers in but not another upgrader nor a
+     * writer, and upgradeable_access::upgrade() turns it into an exclusive lock
+     * without releasing it, so that what was read before stays true :
+     * ```cpp
+     * llh::mutexed::Mutexed<std::map<int, std::string>, llh::mutexed::upgrade_mutex> cache;
+     *
+     * cache.with_upgradeable_locked([&](auto& access) {
+     *     if (!access->contains(key)) {
+     *         access.upgrade().emplace(key, compute(key));
+     *     }
+     * });
+     * ```
+     * If @ref Waiting is enabled and the lock was upgraded, the @a inner
+     * condition-variable is notified after the <em>inner mutex</em> is unlocked.
+     */
+    template<typename F>
+    requires upgrade_lockable<M> && std::invocable<F, upgradeable_access&>
+    decltype(auto) with_upgradeable_locked(F&& f) LLH_MUTEXED_EXCLUDES(this) {
+        upgradeable_access access(*this);
+        return std::invoke(std::forward<F>(f), access);
+    }
+
+    /** The handle that with_downgradable_locked() provides to its functor.
+     *
+     * It gives mutable access to the wrapped value while the <em>inner
+     * mutex</em> is exclusively locked, until downgrade() turns that lock into
+     * a shared one. Only the `const` reference returned by downgrade() may be
+     * used afterwards.
+     */
+    class downgradable_access {
+    private:
+        Mutexed& m_;
+        bool downgraded_ = false;
+
+        friend Mutexed;
+
+        explicit downgradable_access(Mutexed& m) : m_(m) {
+            LLH_MUTEXED_USDT_PROBE(acquire_begin, &m_, lock_mode::exclusive);
+            m_.mtx_.lock();
+            LLH_MUTEXED_USDT_PROBE(acquire_end, &m_, lock_mode::exclusive);
+            m_.invalidate_snapshot();
+        }
+
+        ~downgradable_access() {
+            if (downgraded_) {
+                m_.mtx_.unlock_shared();
+                LLH_MUTEXED_USDT_PROBE(release, &m_, lock_mode::shared);
+            } else {
+                m_.mtx_.unlock();
+                LLH_MUTEXED_USDT_PROBE(release, &m_, lock_mode::exclusive);
+                m_.notify_waiters();
+            }
+        }
+
+    public:
+        downgradable_access(downgradable_access const&) = delete;
+        downgradable_access& operator=(downgradable_access const&) = delete;
+
+        T& operator*() const { return m_.val_; }
+        T* operator->() const { return &m_.val_; }
+
+        //! Turns the exclusive lock into a shared one, if it has not been done
+        //! yet, notifies the @a inner condition-variable if @ref Waiting is
+        //! enabled, and returns a `const` reference to the wrapped value.
+        T const& downgrade() {
+            if (!downgraded_) {
+                m_.mtx_.unlock_and_lock_shared();
+                LLH_MUTEXED_USDT_PROBE(release, &m_, lock_mode::exclusive);
+                LLH_MUTEXED_USDT_ACQUIRED(&m_, lock_mode::shared);
+                downgraded_ = true;
+                m_.notify_waiters();
+            }
+            return m_.val_;
+        }
+
+        //! Whether downgrade() has been called.
+        bool downgraded() const { return downgraded_; }
+    };
+
+    /** Calls @a f with a downgradable_access to the wrapped value while
+     *  exclusively locking the <em>inner mutex</em>.
+     *
+     * Calling downgradable_access::downgrade() lets the other readers in for the
+     * rest of @a f without releasing the lock, so that they see what was written
+     * and nothing else :
+     * ```cpp
+     * llh::mutexed::Mutexed<Table, llh::mutexed::upgrade_mutex, llh::mutexed::has_cv> table;
+     *
+     * auto response = table.with_downgradable_locked([&](auto& access) {
+     *     access->insert(row);
+     *     Table const& t = access.downgrade(); // the waiters are notified here
+     *     return build_response(t);            // long, but readers can proceed
+     * });
+     * ```
+     * If @ref Waiting is enabled, the @a inner condition-variable is notified
+     * at the downgrade, or after the <em>inner mutex</em> is unlocked if there
+     * was none.
+     */
+    template<typename F>
+    requires downgradable<M> && std::invocable<F, downgradable_access&>
+    decltype(auto) with_downgradable_locked(F&& f) LLH_MUTEXED_EXCLUDES(this) {
+        downgradable_access access(*this);
+        return std::invoke(std::forward<F>(f), access);
+    }
+
+    /** Calls @a f with a reference on the wrapped value while locking the
+     *  <em>inner mutex</em>, only if @a pred returns `true` for that value.
+     *
+     * If the <em>inner mutex</em> is @link llh::mutexed::shared_lockable
+     * shared_lockable @endlink, @a pred is first called under a shared lock,
+     * and the exclusive lock is only taken if it returned `true`, in which
+     * case @a pred is called again under that lock before @a f. Calls that end
+     * up not calling @a f thus take no exclusive lock, or release it right
+     * away, and do not notify the @a inner condition-variable :
+     * ```cpp
+     * llh::mutexed::Mutexed<std::vector<Job>, std::shared_mutex, llh::mutexed::has_cv> jobs;
+     *
+     * jobs.with_locked_if([](auto const& v) { return v.size() > max_size; },
+     *                     [](auto& v) { v.resize(max_size); });
+     * ```
+     * The result is whether @a f was called if it returns `void`, and an
+     * `std::optional` of its decayed result otherwise.
+     */
+    template<typename Predicate, typename F>
+    requires invokable_with<Predicate, T const&> && invokable_with<F, T&>
+    auto with_locked_if(Predicate&& pred, F&& f) LLH_MUTEXED_EXCLUDES(this) {
+        using result = details::try_result_t<std::invoke_result_t<F, T&>>;
+        if constexpr (shared_lockable<M>) {
+            LLH_MUTEXED_USDT_LOCK_SCOPE(this, lock_mode::shared);
+            std::shared_lock lock(mtx_);
+            LLH_MUTEXED_USDT_LOCKED();
+            if (!std::invoke(pred, std::as_const(val_))) {
+                return result{};
+            }
+        }
+        bool called = false;
+        // Declared before the lock so that it notifies after the unlock, if f was called.
+        notify_if_changed nc{*this, called};
+        LLH_MUTEXED_USDT_LOCK_SCOPE(this, lock_mode::exclusive);
+        std::lock_guard lock(mtx_);
+        LLH_MUTEXED_USDT_LOCKED();
+        if (!std::invoke(pred, std::as_const(val_))) {
+            return result{};
+        }
+        called = true;
+        this->invalidate_snapshot();
+        return details::invoke_if(&val_, std::forward<F>(f));
+    }
+
+    /** Same as the non-`const` with_locked() with a functor that returns
+     *  whether it changed the value, which is only notified if it did.
+     *
+     * ```cpp
+     * bool const added = ids.with_locked(llh::mutexed::report_change, [id](auto& set) {
+     *     return set.insert(id).second;
+     * });
+     * ```
+     */
+    template<typename F>
+    requires invokable_with<F, T&> && std::convertible_to<std::invoke_result_t<F, T&>, bool>
+    bool with_locked(report_change_t, F&& f) LLH_MUTEXED_EXCLUDES(this) {
+        bool changed = false;
+        notify_if_changed nc{*this, changed};
+        LLH_MUTEXED_USDT_LOCK_SCOPE(this, lock_mode::exclusive);
+        std::lock_guard lock(mtx_);
+        LLH_MUTEXED_USDT_LOCKED();
+        this->invalidate_snapshot();
+        changed = static_cast<bool>(std::invoke(f, val_));
+        return changed;
+    }
+
+    /** Same as the non-`const` with_locked(), but the <em>inner
+     *  condition-variable</em> is only notified if the value compares unequal
+     *  to a copy of it made before calling @a f.
+     *
+     * It is meant for cheap types, and makes no copy if @ref Waiting is not
+     * enabled. If @a f or the comparison throws, the exception propagates and
+     * the waiters are notified.
+     */
+    template<typename F>
+    requires invokable_with<F, T&> && std::equality_comparable<T> && std::is_copy_constructible_v<T>
+    decltype(auto) with_locked(detect_change_t, F&& f) LLH_MUTEXED_EXCLUDES(this) {
+        if constexpr (std::is_same_v<H, has_cv>) {
+            using result_type = std::invoke_result_t<F, T&>;
+            // Stays true if f or the comparison throws.
+            bool changed = true;
+            notify_if_changed nc{*this, changed};
+            LLH_MUTEXED_USDT_LOCK_SCOPE(this, lock_mode::exclusive);
+            std::lock_guard lock(mtx_);
+            LLH_MUTEXED_USDT_LOCKED();
+            this->invalidate_snapshot();
+            T const before(val_);
+            if constexpr (std::is_void_v<result_type>) {
+                std::invoke(f, val_);
+                changed = !(before == val_);
+            } else {
+                result_type result = std::invoke(f, val_);
+                changed = !(before == val_);
+                if constexpr (std::is_reference_v<result_type>) {
+                    return static_cast<result_type>(result);
+                } else {
+                    return result;
+                }
+            }
+        } else {
+            LLH_MUTEXED_USDT_LOCK_SCOPE(this, lock_mode::exclusive);
+            std::lock_guard lock(mtx_);
+            LLH_MUTEXED_USDT_LOCKED();
+            this->invalidate_snapshot();
+            return std::invoke(f, val_);
+        }
+    }
+
+    /** @defgroup MovingOut Moving the value out
+     * These functions are write-accesses that hold the <em>inner mutex</em>
+     * only for the moves or swaps of the value, which for containers are a few
+     * pointer assignments, while the destruction of what is replaced happens
+     * after the unlock. Together with @ref Waiting, they make a batch-drain
+     * primitive :
+     * ```cpp
+     * llh::mutexed::Mutexed<std::vector<Event>, std::mutex, llh::mutexed::has_cv> events;
+     *
+     * std::vector<Event> batch;
+     * batch.reserve(1024);
+     * for (;;) {
+     *     events.wait([](auto const& v) { return !v.empty(); });
+     *     events.drain_into(batch); // the producers keep the capacity of the last batch
+     *     process(batch);
+     * }
+     * ```
+     * @{
+     */
+
+    //! Replaces the wrapped value with @a new_value and returns the former one.
+    template<typename U = T>
+    requires std::is_move_constructible_v<T> && std::is_assignable_v<T&, U&&>
+    T exchange(U&& new_value) LLH_MUTEXED_EXCLUDES(this) {
+        return with_locked([&new_value](T& val) { return std::exchange(val, std::forward<U>(new_value)); });
+    }
+
+    //! Swaps the wrapped value with @a other.
+    template<typename = void>
+    requires std::is_swappable_v<T>
+    void swap(T& other) LLH_MUTEXED_EXCLUDES(this) {
+        with_locked([&other](T& val) {
+            using std::swap;
+            swap(val, other);
+        });
+    }
+
+    //! Moves the wrapped value out, leaving a value-initialized `T` in its place.
+    template<typename = void>
+    requires std::is_move_constructible_v<T> && std::is_default_constructible_v<T>
+    T take() LLH_MUTEXED_EXCLUDES(this) {
+        return exchange(T{});
+    }
+
+    /** Clears @a spare, then swaps it with the wrapped value.
+     *
+     * The wrapped value ends up empty but with the capacity of @a spare, so
+     * that the producers filling it do not reallocate, and @a spare holds what
+     * was drained. Clearing happens before locking the <em>inner mutex</em>.
+     */
+    template<typename = void>
+    requires std::is_swappable_v<T> && requires(T& t) { t.clear(); }
+    void drain_into(T& spare) LLH_MUTEXED_EXCLUDES(this) {
+        spare.clear();
+        swap(spare);
+    }
+
+    //! @}
+    // end group MovingOut
+
+    /** Copy-assigns the wrapped value to @a out while locking the <em>inner
+     *  mutex</em> as get_copy() does.
+     *
+     * Unlike get_copy(), it reuses the storage of @a out, such as the
+     * capacity of a `std::vector` or `std::string`, so that a caller that
+     * keeps the same destination does not allocate once it is large enough.
+     * @a out may be of any type that can be assigned from a `T const&`.
+     */
+    template<typename U>
+    requires std::is_assignable_v<U&, T const&>
+    void copy_into(U& out) const LLH_MUTEXED_EXCLUDES(this) {
+        LLH_MUTEXED_USDT_LOCK_SCOPE(this, read_mode);
+        possibly_shared_lock lock(mtx_);
+        LLH_MUTEXED_USDT_LOCKED();
+        out = val_;
+    }
+
+    /** Returns a shared immutable copy of the wrapped value, which is only
+     *  made by the first call following a write-access.
+     *
+     * Every exclusive lock of the <em>inner mutex</em> drops the cached copy,
+     * and the next call to this function makes a new one while locking it as
+     * get_copy() does. The calls in between share that copy without locking
+     * anything but the atomic `std::shared_ptr` that holds it, which suits
+     * large values read by many threads and rarely written :
+     * ```cpp
+     * llh::mutexed::Mutexed<Config, std::shared_mutex, llh::mutexed::no_cv, llh::mutexed::has_snapshot> config;
+     *
+     * std::shared_ptr<Config const> current = config.get_snapshot();
+     * ```
+     * It is only available if @a S is has_snapshot.
+     */
+    template<typename = void>
+    requires std::is_same_v<S, has_snapshot> && std::is_copy_constructible_v<T>
+    std::shared_ptr<T const> get_snapshot() const LLH_MUTEXED_EXCLUDES(this) {
+        if (auto snapshot = this->snapshot_.load(std::memory_order_acquire)) {
+            return snapshot;
+        }
+        // The writers cannot drop the snapshot while it is being published under this lock.
+        LLH_MUTEXED_USDT_LOCK_SCOPE(this, read_mode);
+        possibly_shared_lock lock(mtx_);
+        LLH_MUTEXED_USDT_LOCKED();
+        std::shared_ptr<T const> expected = this->snapshot_.load(std::memory_order_acquire);
+        if (expected) {
+            return expected;
+        }
+        auto fresh = std::make_shared<T const>(val_);
+        if (this->snapshot_.compare_exchange_strong(expected, fresh, std::memory_order_acq_rel)) {
+            return fresh;
+        }
+        // Another reader published its own copy of the same value first.
+        return expected;
+    }
+
     //! Gets a copy of the wrapped value while locking the inner mutex.
     //! If @a M is @link llh::mutexed::shared_lockable shared_lockable @endlink, `lock_shared()` will be used.
     template<typename = void>
     requires std::is_copy_constructible_v<T>
-    T get_copy() const {
+    T get_copy() const LLH_MUTEXED_EXCLUDES(this) {
+        LLH_MUTEXED_USDT_LOCK_SCOPE(this, read_mode);
         possibly_shared_lock lock(mtx_);
+        LLH_MUTEXED_USDT_LOCKED();
         return val_;
     }
 
+    /** Same as get_copy(), but the copy is constructed with @a alloc by
+     *  uses-allocator construction, so that its memory comes from @a alloc
+     *  instead of the allocator of the wrapped value :
+     * ```cpp
+     * std::pmr::monotonic_buffer_resource request_arena;
+     * std::pmr::vector<int> copy = ints.get_copy(std::pmr::polymorphic_allocator<>(&request_arena));
+     * ```
+     */
+    template<typename Alloc>
+    requires std::uses_allocator_v<T, Alloc>
+    T get_copy(Alloc const& alloc) const LLH_MUTEXED_EXCLUDES(this) {
+        LLH_MUTEXED_USDT_LOCK_SCOPE(this, read_mode);
+        possibly_shared_lock lock(mtx_);
+        LLH_MUTEXED_USDT_LOCKED();
+        return std::make_obj_using_allocator<T>(alloc, std::as_const(val_));
+    }
+
+
+    /** @defgroup NonBlocking Non-blocking and timed accesses
+     * These functions mirror with_locked() and locked() but give up when the
+     * <em>inner mutex</em> cannot be locked right away, with `try_lock()`, or
+     * in time, with `try_lock_for()` and `try_lock_until()`, or their shared
+     * counterparts for the `const` overloads.
+     *
+     * The with_locked() variants return whether the functor was called if it
+     * returns `void`, and an `std::optional` of its decayed result otherwise :
+     * ```cpp
+     * if (auto size = queue.with_locked_for(2ms, [](auto const& q) { return q.size(); })) {
+     *     report(*size);
+     * } else {
+     *     shed_load();
+     * }
+     * ```
+     * The locked() variants return a lock guard that converts to `false` and a
+     * null pointer when the <em>inner mutex</em> was not locked.
+     *
+     * @{
+     */
+
+    //! Same as the `const` with_locked() if the <em>inner mutex</em> can be locked right away.
+    template<typename F>
+    requires
+        invokable_with<F, T const&> ||
+        invokable_with<F, T> && std::is_copy_constructible_v<T>
+    auto try_with_locked(F&& f) const LLH_MUTEXED_EXCLUDES(this) {
+        LLH_MUTEXED_USDT_TRY_LOCK_SCOPE(this, read_mode);
+        auto [lock, val] = read_locked_if(std::try_to_lock);
+        LLH_MUTEXED_USDT_TRIED(val != nullptr);
+        return details::invoke_if(val, std::forward<F>(f));
+    }
+
+    //! Same as the non-`const` with_locked() if the <em>inner mutex</em> can be locked right away.
+    template<typename F>
+    requires invokable_with<F, T&>
+    auto try_with_locked(F&& f) LLH_MUTEXED_EXCLUDES(this) {
+        auto [lock, val] = write_locked_if(mtx_.try_lock());
+        return details::invoke_if(val, std::forward<F>(f));
+    }
+
+    //! Same as the `const` with_locked() if the <em>inner mutex</em> can be locked within @a rel_time.
+    template<class Rep, class Period, typename F>
+    requires read_timed_lockable && (
+        invokable_with<F, T const&> ||
+        invokable_with<F, T> && std::is_copy_constructible_v<T>)
+    auto with_locked_for(std::chrono::duration<Rep, Period> const& rel_time, F&& f) const LLH_MUTEXED_EXCLUDES(this) {
+        LLH_MUTEXED_USDT_TRY_LOCK_SCOPE(this, read_mode);
+        auto [lock, val] = read_locked_if(rel_time);
+        LLH_MUTEXED_USDT_TRIED(val != nullptr);
+        return details::invoke_if(val, std::forward<F>(f));
+    }
+
+    //! Same as the non-`const` with_locked() if the <em>inner mutex</em> can be locked within @a rel_time.
+    template<class Rep, class Period, typename F>
+    requires timed_lockable<M> && invokable_with<F, T&>
+    auto with_locked_for(std::chrono::duration<Rep, Period> const& rel_time, F&& f) LLH_MUTEXED_EXCLUDES(this) {
+        auto [lock, val] = write_locked_if(mtx_.try_lock_for(rel_time));
+        return details::invoke_if(val, std::forward<F>(f));
+    }
+
+    //! Same as the `const` with_locked() if the <em>inner mutex</em> can be locked before @a timeout_time.
+    template<class Clock, class Duration, typename F>
+    requires read_timed_lockable && (
+        invokable_with<F, T const&> ||
+        invokable_with<F, T> && std::is_copy_constructible_v<T>)
+    auto with_locked_until(std::chrono::time_point<Clock, Duration> const& timeout_time, F&& f) const LLH_MUTEXED_EXCLUDES(this) {
+        LLH_MUTEXED_USDT_TRY_LOCK_SCOPE(this, read_mode);
+        auto [lock, val] = read_locked_if(timeout_time);
+        LLH_MUTEXED_USDT_TRIED(val != nullptr);
+        return details::invoke_if(val, std::forward<F>(f));
+    }
+
+    //! Same as the non-`const` with_locked() if the <em>inner mutex</em> can be locked before @a timeout_time.
+    template<class Clock, class Duration, typename F>
+    requires timed_lockable<M> && invokable_with<F, T&>
+    auto with_locked_until(std::chrono::time_point<Clock, Duration> const& timeout_time, F&& f) LLH_MUTEXED_EXCLUDES(this) {
+        auto [lock, val] = write_locked_if(mtx_.try_lock_until(timeout_time));
+        return details::invoke_if(val, std::forward<F>(f));
+    }
+
+    //! Same as locked() if the <em>inner mutex</em> can be locked right away.
+    std::tuple<Lock, T*> try_locked() LLH_MUTEXED_EXCLUDES(this) {
+        return write_locked_if(mtx_.try_lock());
+    }
+    //! Same as locked_const() if the <em>inner mutex</em> can be locked right away.
+    std::tuple<possibly_shared_lock, T const*> try_locked() const LLH_MUTEXED_EXCLUDES(this) {
+        return read_locked_if_returned(std::try_to_lock);
+    }
+
+    //! Same as locked() if the <em>inner mutex</em> can be locked within @a rel_time.
+    template<class Rep, class Period>
+    requires timed_lockable<M>
+    std::tuple<Lock, T*> try_locked_for(std::chrono::duration<Rep, Period> const& rel_time) LLH_MUTEXED_EXCLUDES(this) {
+        return write_locked_if(mtx_.try_lock_for(rel_time));
+    }
+    //! Same as locked_const() if the <em>inner mutex</em> can be locked within @a rel_time.
+    template<class Rep, class Period>
+    requires read_timed_lockable
+    std::tuple<possibly_shared_lock, T const*> try_locked_for(std::chrono::duration<Rep, Period> const& rel_time) const LLH_MUTEXED_EXCLUDES(this) {
+        return read_locked_if_returned(rel_time);
+    }
+
+    //! Same as locked() if the <em>inner mutex</em> can be locked before @a timeout_time.
+    template<class Clock, class Duration>
+    requires timed_lockable<M>
+    std::tuple<Lock, T*> try_locked_until(std::chrono::time_point<Clock, Duration> const& timeout_time) LLH_MUTEXED_EXCLUDES(this) {
+        return write_locked_if(mtx_.try_lock_until(timeout_time));
+    }
+    //! Same as locked_const() if the <em>inner mutex</em> can be locked before @a timeout_time.
+    template<class Clock, class Duration>
+    requires read_timed_lockable
+    std::tuple<possibly_shared_lock, T const*> try_locked_until(std::chrono::time_point<Clock, Duration> const& timeout_time) const LLH_MUTEXED_EXCLUDES(this) {
+        return read_locked_if_returned(timeout_time);
+    }
+
+    //! @}
+    // end group NonBlocking
+
 
     /** @defgroup Waiting The waiting feature
      * The waiting feature is enabled if @a H is has_cv. It makes available the
@@ -319,7 +1931,9 @@ public:
      * Internally, the Mutexed will hold a @a condition-variable that will be
      * notified with `notify_all()` after the unlocking that occurs whenever the
      * <em>inner value</em> has been @a write-accessed, which happens at the end
-     * of the calls to the non-`const` versions of locked() and with_locked().
+     * of the calls to the non-`const` versions of locked() and with_locked(),
+     * and of the calls to with_all_locked() and locked_all() that receive the
+     * Mutexed as non-`const`.
      *
      * Here is an example of waiting on a Mutexed :
      * @code{.cpp}
@@ -362,8 +1976,11 @@ public:
     */
     template<typename Predicate>
     requires std::is_same_v<H, has_cv> && invokable_with<Predicate, T const&>
-    void wait(Predicate&& p) const {
+    void wait(Predicate&& p) const LLH_MUTEXED_EXCLUDES(this) {
+        LLH_MUTEXED_USDT_LOCK_SCOPE(this, read_mode);
         possibly_shared_lock lock(mtx_);
+        LLH_MUTEXED_USDT_LOCKED();
+        traced_wait tw(*this);
         this->cv_.wait(lock, [p = std::forward<Predicate>(p), this](){ return std::invoke(p, val_); });
     }
 
@@ -374,8 +1991,11 @@ public:
     */
     template<class Rep, class Period, typename Predicate>
     requires std::is_same_v<H, has_cv> && invokable_with<Predicate, T const&>
-    bool wait_for(std::chrono::duration<Rep, Period> const& rel_time, Predicate&& p) const {
+    bool wait_for(std::chrono::duration<Rep, Period> const& rel_time, Predicate&& p) const LLH_MUTEXED_EXCLUDES(this) {
+        LLH_MUTEXED_USDT_LOCK_SCOPE(this, read_mode);
         possibly_shared_lock lock(mtx_);
+        LLH_MUTEXED_USDT_LOCKED();
+        traced_wait tw(*this);
         return this->cv_.wait_for(lock, rel_time, [p = std::forward<Predicate>(p), this](){ return std::invoke(p, val_); });
     }
 
@@ -386,8 +2006,11 @@ public:
     */
     template<class Clock, class Duration, typename Predicate>
     requires std::is_same_v<H, has_cv> && invokable_with<Predicate, T const&>
-    bool wait_until(std::chrono::time_point<Clock, Duration> const& timeout_time, Predicate&& p) const {
+    bool wait_until(std::chrono::time_point<Clock, Duration> const& timeout_time, Predicate&& p) const LLH_MUTEXED_EXCLUDES(this) {
+        LLH_MUTEXED_USDT_LOCK_SCOPE(this, read_mode);
         possibly_shared_lock lock(mtx_);
+        LLH_MUTEXED_USDT_LOCKED();
+        traced_wait tw(*this);
         return this->cv_.wait_until(lock, timeout_time, [p = std::forward<Predicate>(p), this](){ return std::invoke(p, val_); });
     }
 
@@ -411,34 +2034,18 @@ public:
      *  returning the tuple. The lock-guard returned has a destructor that
      *  unlocks the <i>inner mutex</i> and then, if @ref Waiting is enabled,
      *  notifies the <i>inner condition-variable</i>.
+     *
+     *  If the <em>inner mutex</em> is @link llh::mutexed::downgradable
+     *  downgradable @endlink, the lock guard also has a `downgrade()` member
+     *  function that turns the lock into a shared one, notifies at that point
+     *  instead, and returns a `const` reference through which the value must
+     *  be read afterwards.
      */
-    decltype(auto) locked() {
-        class Lock {
-        private:
-            Mutexed& m;
-
-            void lock()   { m.mtx_.lock(); }
-            void unlock() { m.mtx_.unlock(); }
-
-        public:
-            explicit Lock(Mutexed& mtx) : m(mtx) { lock(); }
-
-            ~Lock() {
-                unlock();
-                if constexpr (std::is_same_v<H, has_cv>) {
-                    m.cv_.notify_all();
-                }
-            }
-
-            // Copies would mess with unlocks and notifications
-            Lock(Lock const&) = delete;
-            // Moves could have use-cases but would require tracking an otherwise useless state
-            Lock(Lock &&) = delete;
-        };
+    decltype(auto) locked() LLH_MUTEXED_EXCLUDES(this) {
         return std::tuple<Lock, T&>(*this, val_);
     }
     //! Same as locked_const().
-    std::tuple<possibly_shared_lock, T const&> locked() const {
+    std::tuple<possibly_shared_lock, T const&> locked() const LLH_MUTEXED_EXCLUDES(this) {
         return locked_const();
     }
     /**
@@ -460,17 +2067,128 @@ public:
      *
      *  The lock guard returned has a destructor that unlocks the <i>inner mutex</i>.
      */
-    std::tuple<possibly_shared_lock, T const&> locked_const() const {
-        return std::tuple<possibly_shared_lock, T const&>{mtx_, val_};
+    std::tuple<possibly_shared_lock, T const&> locked_const() const LLH_MUTEXED_EXCLUDES(this) {
+        LLH_MUTEXED_USDT_PROBE(acquire_begin, this, read_mode);
+        std::tuple<possibly_shared_lock, T const&> locked{mtx_, val_};
+        LLH_MUTEXED_USDT_PROBE(acquire_end, this, read_mode);
+        return locked;
     }
 };
 
 
 //! A value for the disambiguation tag type mutex_args_t provided as convenience.
 inline constexpr mutex_args_t mutex_args{};
+//! A value for the disambiguation tag type report_change_t provided as convenience.
+inline constexpr report_change_t report_change{};
+//! A value for the disambiguation tag type detect_change_t provided as convenience.
+inline constexpr detect_change_t detect_change{};
 inline constexpr value_args_t value_args{};
 
-//! A functor that locks in a deadlock-free way all the provided Mutexed.
+//! A value for the disambiguation tag type backoff_locking_t provided as convenience.
+inline constexpr backoff_locking_t backoff_locking{};
+//! A value for the disambiguation tag type ordered_locking_t provided as convenience.
+inline constexpr ordered_locking_t ordered_locking{};
+
+/** A functor that locks in a deadlock-free way all the provided Mutexed.
+ *
+ * Once they are all unlocked, the <i>inner condition-variable</i> of those that
+ * were provided as non-`const` and for which @ref Waiting is enabled is notified.
+ *
+ * The acquisition strategy is default_locking_t unless backoff_locking or
+ * ordered_locking is provided as first argument :
+ * ```cpp
+ * with_all_locked(ordered_locking, [](auto& a, auto const& b) { a += b; }, mutexed_a, std::cref(mutexed_b));
+ * ```
+ */
 inline constexpr details::all_locker with_all_locked{};
 
+/** A functor that calls the provided function with all the provided Mutexed
+ *  locked, as with_all_locked() does, only if they can all be locked right away.
+ *
+ * It returns the same as the @ref NonBlocking "non-blocking functions" of Mutexed :
+ * ```cpp
+ * if (!try_with_all_locked([](auto& a, auto const& b) { a += b; }, mutexed_a, std::cref(mutexed_b))) {
+ *     shed_load();
+ * }
+ * ```
+ */
+inline constexpr details::all_try_locker try_with_all_locked{};
+
+/** Waits until any of the provided predicates returns `true` for its Mutexed,
+ *  and returns the index of the first such pair.
+ *
+ * The arguments alternate predicates and Mutexed for which @ref Waiting is
+ * enabled, as in :
+ * ```cpp
+ * switch (llh::mutexed::wait_any(
+ *     [](auto const& q) { return !q.empty(); }, jobs,
+ *     [](bool stop) { return stop; },           shutdown))
+ * {
+ *     case 0: // a job is available
+ *     case 1: // shutdown was requested
+ * }
+ * ```
+ * The calling thread registers itself in every Mutexed and sleeps until any of
+ * them is write-accessed, then checks all the predicates again, each one while
+ * locking only its Mutexed as wait() does. Nothing is held on return, so
+ * another thread may have changed the values since the predicate returned
+ * `true`, and a caller that acts on a value checks its predicate again under
+ * the lock it takes for that, as with_locked_if() does.
+ */
+template<typename... Args>
+requires (details::are_wait_pairs<Args...>())
+std::size_t wait_any(Args&&... args) {
+    return details::multi_waiter::wait_any(std::forward<Args>(args)...);
+}
+
+/** Waits until all the provided predicates return `true` for their Mutexed at
+ *  the same time.
+ *
+ * The arguments are the same as for wait_any(). The predicates are checked
+ * together, under a lock of all the Mutexed taken as with_all_locked() does
+ * with `const` arguments, whenever any of them is write-accessed. That lock is
+ * released before returning, as for wait_any().
+ */
+template<typename... Args>
+requires (details::are_wait_pairs<Args...>())
+void wait_all(Args&&... args) {
+    details::multi_waiter::wait_all(std::forward<Args>(args)...);
+}
+
+/**
+ *  @brief Provides access to the <i>wrapped values</i> of all the provided
+ *  Mutexed through a tuple of an unspecified lock guard followed by a
+ *  reference to each value.
+ *
+ *  Use it this way :
+ *  ```cpp
+ *  {
+ *      auto [lock, a, b, c] = llh::mutexed::locked_all(mutexed_a, std::cref(mutexed_b), mutexed_c);
+ *      a += b;
+ *      c -= b;
+ *  }
+ *  ```
+ *
+ *  The <em>inner mutexes</em> are acquired once, the same way as
+ *  with_all_locked() does with the same arguments, including the shared
+ *  locking of the Mutexed passed as `const`. The lock guard returned has a
+ *  destructor that unlocks all of them and then notifies the <i>inner
+ *  condition-variable</i> of those that were not passed as `const` and for
+ *  which @ref Waiting is enabled.
+ */
+template<typename... M>
+requires (sizeof...(M) > 0) &&
+    std::conjunction_v<std::is_base_of<details::mutexed_tag, details::decay_through_ref_wrap_t<M>>...>
+auto locked_all(M&&... mtxs) {
+    return details::all_locker::locked<default_locking_t>(std::forward<M>(mtxs)...);
+}
+
+//! Same as locked_all() with the acquisition strategy provided as first argument.
+template<locking_strategy Locking, typename... M>
+requires (sizeof...(M) > 0) &&
+    std::conjunction_v<std::is_base_of<details::mutexed_tag, details::decay_through_ref_wrap_t<M>>...>
+auto locked_all(Locking, M&&... mtxs) {
+    return details::all_locker::locked<std::decay_t<Locking>>(std::forward<M>(mtxs)...);
+}
+
 } // end namespace llh::mutexed
@@ -0,0 +1,416 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include "../mutexed.hpp"
+
+namespace llh::mutexed {
+
+/** A fixed-capacity circular buffer, the default storage of bounded_queue.
+ *
+ * Unlike `std::deque`, it allocates once, in reserve(), and pushing or
+ * popping only constructs or destroys the element.
+ */
+template<typename T>
+class ring_buffer {
+private:
+    std::allocator<T> alloc_;
+    T* data_ = nullptr;
+    std::size_t capacity_ = 0;
+    std::size_t head_ = 0;
+    std::size_t size_ = 0;
+
+    std::size_t index(std::size_t i) const {
+        std::size_t const j = head_ + i;
+        return j < capacity_ ? j : j - capacity_;
+    }
+
+public:
+    using value_type = T;
+
+    ring_buffer() = default;
+    ring_buffer(ring_buffer const&) = delete;
+    ring_buffer& operator=(ring_buffer const&) = delete;
+
+    ~ring_buffer() {
+        clear();
+        if (data_) {
+            alloc_.deallocate(data_, capacity_);
+        }
+    }
+
+    //! Makes room for @a new_capacity elements, moving the current ones if it reallocates.
+    void reserve(std::size_t new_capacity) {
+        if (new_capacity <= capacity_) {
+            return;
+        }
+        T* const data = alloc_.allocate(new_capacity);
+        for (std::size_t i = 0; i < size_; ++i) {
+            std::construct_at(data + i, std::move(data_[index(i)]));
+            std::destroy_at(data_ + index(i));
+        }
+        if (data_) {
+            alloc_.deallocate(data_, capacity_);
+        }
+        data_ = data;
+        capacity_ = new_capacity;
+        head_ = 0;
+    }
+
+    //! Constructs an element at the back, which requires size() to be lower than capacity().
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
+        T* const slot = data_ + index(size_);
+        std::construct_at(slot, std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    template<typename U>
+    void push_back(U&& value) { emplace_back(std::forward<U>(value)); }
+
+    T& front() { return data_[head_]; }
+    T const& front() const { return data_[head_]; }
+
+    void pop_front() {
+        std::destroy_at(data_ + head_);
+        head_ = index(1);
+        --size_;
+    }
+
+    void clear() {
+        while (size_ != 0) {
+            pop_front();
+        }
+        head_ = 0;
+    }
+
+    std::size_t size() const { return size_; }
+    std::size_t capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+};
+
+//! Checks if S can hold the elements of a bounded_queue, such as ring_buffer or `std::deque`.
+template<typename S>
+concept queue_storage = std::is_default_constructible_v<S> &&
+    requires(S& s, S const& cs, typename S::value_type&& v) {
+        s.push_back(std::move(v));
+        { s.front() } -> std::same_as<typename S::value_type&>;
+        s.pop_front();
+        { cs.size() } -> std::convertible_to<std::size_t>;
+    };
+
+namespace details {
+
+/* One of the two wait channels of a bounded_queue, whose waiters are the
+   external_waiter s of wait_any() and wait_all() registered in a
+   waiter_registry. Unlike a Mutexed, it signals a single waiter per element
+   pushed or slot freed, and none when nobody waits.
+ */
+struct wait_channel : waiter_registry {
+    // Signals up to @a nb waiters that have not been signaled yet.
+    void signal_some(std::size_t nb) const {
+        if (nb == 0 || nb_waiters_.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+        std::lock_guard lock(waiters_mtx_);
+        for (waiter_node* n = waiters_; n && nb != 0; n = n->next) {
+            external_waiter& w = *n->waiter;
+            {
+                std::lock_guard wlock(w.mtx);
+                if (w.signaled) {
+                    continue;
+                }
+                w.signaled = true;
+            }
+            w.cv.notify_one();
+            --nb;
+        }
+    }
+
+    /* Calls `check()`, which locks the queue, until its result converts to
+       `true` or @a deadline, if any, is reached. A signal received by a waiter
+       that does not need it any more is passed on to another one, so that
+       none is lost.
+     */
+    template<typename Check, typename Deadline = std::nullptr_t>
+    auto wait(Check&& check, Deadline const& deadline = nullptr) const {
+        // The uncontended case does not register anything.
+        decltype(check()) result = check();
+        if (result) {
+            return result;
+        }
+        external_waiter w;
+        {
+            multi_waiter::registration<wait_channel> reg(w, *this);
+            while (true) {
+                {
+                    std::lock_guard lock(w.mtx);
+                    w.signaled = false;
+                }
+                if ((result = check())) {
+                    break;
+                }
+                std::unique_lock lock(w.mtx);
+                auto const signaled = [&w] { return w.signaled; };
+                if constexpr (std::is_same_v<Deadline, std::nullptr_t>) {
+                    w.cv.wait(lock, signaled);
+                } else if (!w.cv.wait_until(lock, deadline, signaled)) {
+                    break;
+                }
+            }
+        }
+        if (std::lock_guard lock(w.mtx); !w.signaled) {
+            return result;
+        }
+        signal_some(1);
+        return result;
+    }
+};
+
+} // end namespace details
+
+/** A blocking multi-producer multi-consumer queue of at most `capacity()`
+ *  elements, whose storage is protected by a Mutexed.
+ *
+ * Unlike a `Mutexed<std::deque<T>, std::mutex, has_cv>` used with wait() and
+ * the mutable with_locked(), which wakes up all the waiters at every write :
+ * - the producers waiting for room and the consumers waiting for elements
+ *   wait on two separate channels,
+ * - pushing or popping wakes up one waiter per element or slot, and nobody
+ *   when no thread waits, without any system call,
+ * - the default ring_buffer storage never allocates after the construction,
+ * - push_n() and pop_n() move whole batches under a single lock.
+ *
+ * ```cpp
+ * llh::mutexed::bounded_queue<Job> jobs(1024);
+ *
+ * // producers
+ * jobs.push(Job{...});
+ *
+ * // consumers
+ * std::vector<Job> batch;
+ * jobs.pop_n(std::back_inserter(batch), 64);
+ * ```
+ *
+ * @tparam T the type of the elements.
+ * @tparam M the type of the mutex of the Mutexed.
+ * @tparam Storage the container of the elements, a ring_buffer by default,
+ *         which is reserved to the capacity when it has a `reserve()` member function.
+ */
+template<typename T, typename M = std::mutex, queue_storage Storage = ring_buffer<T>>
+class bounded_queue {
+private:
+    std::size_t capacity_;
+    Mutexed<Storage, M> storage_;
+    details::wait_channel not_empty_;
+    details::wait_channel not_full_;
+
+    template<typename U>
+    bool push_locked(U&& value) {
+        bool const pushed = storage_.with_locked([this, &value](Storage& s) {
+            if (s.size() >= capacity_) {
+                return false;
+            }
+            s.push_back(std::forward<U>(value));
+            return true;
+        });
+        if (pushed) {
+            not_empty_.signal_some(1);
+        }
+        return pushed;
+    }
+
+    std::optional<T> pop_locked() {
+        std::optional<T> popped = storage_.with_locked([](Storage& s) -> std::optional<T> {
+            if (s.size() == 0) {
+                return std::nullopt;
+            }
+            std::optional<T> front(std::move(s.front()));
+            s.pop_front();
+            return front;
+        });
+        if (popped) {
+            not_full_.signal_some(1);
+        }
+        return popped;
+    }
+
+    template<typename It, typename Sentinel>
+    std::size_t push_n_locked(It& first, Sentinel const& last) {
+        std::size_t const nb = storage_.with_locked([this, &first, &last](Storage& s) {
+            std::size_t pushed = 0;
+            for (; first != last && s.size() < capacity_; ++first, ++pushed) {
+                s.push_back(*first);
+            }
+            return pushed;
+        });
+        not_empty_.signal_some(nb);
+        return nb;
+    }
+
+    template<typename Out>
+    std::size_t pop_n_locked(Out& out, std::size_t max) {
+        std::size_t const nb = storage_.with_locked([&out, max](Storage& s) {
+            std::size_t popped = 0;
+            for (; popped < max && s.size() != 0; ++popped) {
+                *out = std::move(s.front());
+                ++out;
+                s.pop_front();
+            }
+            return popped;
+        });
+        not_full_.signal_some(nb);
+        return nb;
+    }
+
+public:
+    using value_type = T;
+
+    //! Constructs an empty queue that holds at most @a capacity elements.
+    explicit bounded_queue(std::size_t capacity) : capacity_(capacity) {
+        storage_.with_locked([capacity](Storage& s) {
+            if constexpr (requires { s.reserve(capacity); }) {
+                s.reserve(capacity);
+            }
+        });
+    }
+
+    bounded_queue(bounded_queue const&) = delete;
+    bounded_queue(bounded_queue&&) = delete;
+
+    //! The maximum number of elements.
+    std::size_t capacity() const { return capacity_; }
+
+    //! The number of elements, which may have changed once it returns.
+    std::size_t size() const {
+        return storage_.with_locked([](Storage const& s) -> std::size_t { return s.size(); });
+    }
+
+    //! Whether the queue is empty, which may have changed once it returns.
+    bool empty() const { return size() == 0; }
+
+    /** @defgroup QueuePushing Pushing
+     * The single-element functions take the element by forwarding reference,
+     * and only move from it once it is in the queue.
+     * @{
+     */
+
+    //! Pushes @a value, waiting for room if the queue is full.
+    template<typename U>
+    requires std::is_constructible_v<T, U&&>
+    void push(U&& value) {
+        not_full_.wait([this, &value] { return push_locked(std::forward<U>(value)); });
+    }
+
+    //! Pushes @a value if the queue is not full, and returns whether it did.
+    template<typename U>
+    requires std::is_constructible_v<T, U&&>
+    bool try_push(U&& value) {
+        return push_locked(std::forward<U>(value));
+    }
+
+    //! Same as push() but gives up after @a rel_time, and returns whether it pushed.
+    template<class Rep, class Period, typename U>
+    requires std::is_constructible_v<T, U&&>
+    bool try_push_for(std::chrono::duration<Rep, Period> const& rel_time, U&& value) {
+        return try_push_until(std::chrono::steady_clock::now() + rel_time, std::forward<U>(value));
+    }
+
+    //! Same as push() but gives up at @a timeout_time, and returns whether it pushed.
+    template<class Clock, class Duration, typename U>
+    requires std::is_constructible_v<T, U&&>
+    bool try_push_until(std::chrono::time_point<Clock, Duration> const& timeout_time, U&& value) {
+        return not_full_.wait([this, &value] { return push_locked(std::forward<U>(value)); }, timeout_time);
+    }
+
+    /** Pushes the elements of [@a first, @a last) in order, in as few
+     *  batches as the room in the queue allows, waiting for room between them.
+     *
+     * Use `std::make_move_iterator` to move the elements instead of copying them.
+     */
+    template<std::input_iterator It, std::sentinel_for<It> Sentinel>
+    requires std::is_constructible_v<T, std::iter_reference_t<It>>
+    void push_n(It first, Sentinel last) {
+        while (first != last) {
+            not_full_.wait([&] { return push_n_locked(first, last); });
+        }
+    }
+
+    //! Pushes as many elements of [@a first, @a last) as there is room for, and returns their number.
+    template<std::input_iterator It, std::sentinel_for<It> Sentinel>
+    requires std::is_constructible_v<T, std::iter_reference_t<It>>
+    std::size_t try_push_n(It first, Sentinel last) {
+        return push_n_locked(first, last);
+    }
+
+    //! @}
+    // end group QueuePushing
+
+    /** @defgroup QueuePopping Popping
+     * @{
+     */
+
+    //! Pops the oldest element, waiting for one if the queue is empty.
+    T pop() {
+        return *not_empty_.wait([this] { return pop_locked(); });
+    }
+
+    //! Pops the oldest element if the queue is not empty.
+    std::optional<T> try_pop() {
+        return pop_locked();
+    }
+
+    //! Same as pop() but gives up after @a rel_time.
+    template<class Rep, class Period>
+    std::optional<T> try_pop_for(std::chrono::duration<Rep, Period> const& rel_time) {
+        return try_pop_until(std::chrono::steady_clock::now() + rel_time);
+    }
+
+    //! Same as pop() but gives up at @a timeout_time.
+    template<class Clock, class Duration>
+    std::optional<T> try_pop_until(std::chrono::time_point<Clock, Duration> const& timeout_time) {
+        return not_empty_.wait([this] { return pop_locked(); }, timeout_time);
+    }
+
+    /** Waits for the queue not to be empty, then moves up to @a max of the
+     *  oldest elements to @a out under a single lock, and returns their number.
+     */
+    template<std::weakly_incrementable Out>
+    requires std::indirectly_writable<Out, T&&>
+    std::size_t pop_n(Out out, std::size_t max) {
+        if (max == 0) {
+            return 0;
+        }
+        return not_empty_.wait([&] { return pop_n_locked(out, max); });
+    }
+
+    //! Same as pop_n() without waiting, which returns 0 if the queue is empty.
+    template<std::weakly_incrementable Out>
+    requires std::indirectly_writable<Out, T&&>
+    std::size_t try_pop_n(Out out, std::size_t max) {
+        return pop_n_locked(out, max);
+    }
+
+    //! Same as pop_n() but gives up after @a rel_time, and returns 0 then.
+    template<class Rep, class Period, std::weakly_incrementable Out>
+    requires std::indirectly_writable<Out, T&&>
+    std::size_t try_pop_n_for(std::chrono::duration<Rep, Period> const& rel_time, Out out, std::size_t max) {
+        if (max == 0) {
+            return 0;
+        }
+        auto const timeout_time = std::chrono::steady_clock::now() + rel_time;
+        return not_empty_.wait([&] { return pop_n_locked(out, max); }, timeout_time);
+    }
+
+    //! @}
+    // end group QueuePopping
+};
+
+} // end namespace llh::mutexed
@@ -0,0 +1,250 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "../mutexed.hpp"
+
+namespace llh::mutexed {
+
+namespace details::chrome {
+
+//! The kinds of events recorded by chrome_tracer, in the order of the hooks of tracing_policy.
+enum class event_kind : std::uint8_t {
+    acquire_begin, contended, acquire_end, release, notify, wait_begin, wait_end
+};
+
+struct event {
+    std::int64_t ts_ns;
+    void const* mtx;
+    event_kind kind;
+    lock_mode mode;
+};
+
+/* A single-producer single-consumer ring of events : the producer is the
+   thread that owns it, the consumer is whoever writes the trace, which is
+   serialized by the registry. Events are dropped when the ring is full.
+ */
+template<std::size_t Capacity>
+class event_ring {
+private:
+    std::array<event, Capacity> events_;
+    std::atomic<std::uint64_t> head_{0};
+    std::atomic<std::uint64_t> tail_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+
+public:
+    void push(event const& e) noexcept {
+        auto const head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= Capacity) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        events_[head % Capacity] = e;
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    template<typename F>
+    void drain(F&& f) {
+        auto const head = head_.load(std::memory_order_acquire);
+        auto tail = tail_.load(std::memory_order_relaxed);
+        for (; tail != head; ++tail) {
+            f(events_[tail % Capacity]);
+        }
+        tail_.store(tail, std::memory_order_release);
+    }
+
+    std::uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+};
+
+template<std::size_t Capacity>
+struct thread_buffer {
+    std::uint32_t tid;
+    event_ring<Capacity> ring;
+
+    explicit thread_buffer(std::uint32_t id) : tid(id) {}
+};
+
+inline char const* mode_name(lock_mode mode) {
+    return mode == lock_mode::shared ? "shared" : "exclusive";
+}
+
+/* Writes an event in the Chrome trace-event format. The acquisitions and the
+   waits are duration events of their thread, while the time a mutex is held
+   is an async event identified by the address of the mutex, because a wait
+   releases the mutex in the middle of its duration event.
+ */
+inline void write_event(std::ostream& os, event const& e, std::uint32_t tid) {
+    char const* name = "";
+    char const* phase = "";
+    bool held = false;
+    switch (e.kind) {
+    case event_kind::acquire_begin: name = "acquire";   phase = "B"; break;
+    case event_kind::contended:     name = "contended"; phase = "i"; break;
+    case event_kind::acquire_end:   name = "acquire";   phase = "E"; break;
+    case event_kind::release:       name = "held";      phase = "e"; held = true; break;
+    case event_kind::notify:        name = "notify";    phase = "i"; break;
+    case event_kind::wait_begin:    name = "wait";      phase = "B"; break;
+    case event_kind::wait_end:      name = "wait";      phase = "E"; break;
+    }
+
+    auto write_one = [&](char const* n, char const* ph, bool async) {
+        os << "{\"name\":\"" << n << "\",\"cat\":\"mutexed\",\"ph\":\"" << ph
+           << "\",\"ts\":" << e.ts_ns / 1000 << '.' << std::to_string(1000 + e.ts_ns % 1000).substr(1)
+           << ",\"pid\":1,\"tid\":" << tid;
+        if (async) {
+            os << ",\"id\":\"" << e.mtx << '"';
+        }
+        if (ph[0] == 'i') {
+            os << ",\"s\":\"t\"";
+        }
+        os << ",\"args\":{\"mutex\":\"" << e.mtx << "\",\"mode\":\"" << mode_name(e.mode) << "\"}}";
+    };
+
+    write_one(name, phase, held);
+    if (e.kind == event_kind::acquire_end) {
+        os << ",\n";
+        write_one("held", "b", true);
+    }
+}
+
+} // end namespace details::chrome
+
+
+/** A tracing policy for traced_mutex that records the events in a lock-free
+ *  ring buffer owned by each thread, and writes them as a
+ *  [Chrome trace-event](https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU)
+ *  JSON file that can be opened with Perfetto or `chrome://tracing`.
+ *
+ * Recording an event does not synchronize with other threads : the only lock
+ * taken is when a thread records its first event and registers its buffer,
+ * unless it called register_thread() before. When a buffer is full, or could
+ * not be allocated, the events are dropped and counted in dropped().
+ *
+ * ```cpp
+ * using tracer = llh::mutexed::chrome_tracer<>;
+ * llh::mutexed::Mutexed<int, llh::mutexed::traced_mutex<std::shared_mutex, tracer>> traced(0);
+ * // ...
+ * tracer::save("mutexed.trace.json");
+ * ```
+ *
+ * @tparam EventsPerThread the capacity of the buffer of each thread.
+ */
+template<std::size_t EventsPerThread = 16384>
+struct chrome_tracer : tracing_policy {
+private:
+    using buffer = details::chrome::thread_buffer<EventsPerThread>;
+    using event = details::chrome::event;
+    using event_kind = details::chrome::event_kind;
+
+    // The buffers are shared with the registry so that the events of a
+    // thread can still be written after it has exited.
+    static Mutexed<std::vector<std::shared_ptr<buffer>>, std::mutex>& registry() {
+        static Mutexed<std::vector<std::shared_ptr<buffer>>, std::mutex> buffers;
+        return buffers;
+    }
+
+    // Null until the buffer of the calling thread is registered.
+    static buffer*& local_buffer() noexcept {
+        thread_local buffer* local = nullptr;
+        return local;
+    }
+
+    // The events of the threads whose buffer could not be registered.
+    static std::atomic<std::uint64_t>& unregistered_dropped() noexcept {
+        static std::atomic<std::uint64_t> nb{0};
+        return nb;
+    }
+
+    /* The hooks are called from the lock functions, which must not throw, so
+       an event whose buffer cannot be allocated or registered is dropped. The
+       registration is tried again by the next event of the thread.
+     */
+    static void record(void const* mtx, event_kind kind, lock_mode mode) noexcept {
+        auto const ts = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        if (!local_buffer()) {
+            try {
+                register_thread();
+            } catch (...) {
+                unregistered_dropped().fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        local_buffer()->ring.push(event{ts, mtx, kind, mode});
+    }
+
+public:
+    static void acquire_begin(void const* mtx, lock_mode mode) noexcept { record(mtx, event_kind::acquire_begin, mode); }
+    static void contended(void const* mtx, lock_mode mode) noexcept     { record(mtx, event_kind::contended, mode); }
+    static void acquire_end(void const* mtx, lock_mode mode) noexcept   { record(mtx, event_kind::acquire_end, mode); }
+    static void release(void const* mtx, lock_mode mode) noexcept       { record(mtx, event_kind::release, mode); }
+    static void notify(void const* mtx) noexcept                        { record(mtx, event_kind::notify, lock_mode::exclusive); }
+    static void wait_begin(void const* mtx, lock_mode mode) noexcept    { record(mtx, event_kind::wait_begin, mode); }
+    static void wait_end(void const* mtx, lock_mode mode) noexcept      { record(mtx, event_kind::wait_end, mode); }
+
+    /** Allocates and registers the buffer of the calling thread, if it has
+     *  none yet, which its first event does otherwise.
+     *
+     * Calling it when a thread starts moves the allocation and the lock of the
+     * registry out of the first traced lock, and reports their failure with
+     * an exception, `std::bad_alloc` or `std::system_error`, where the first
+     * event can only drop itself.
+     */
+    static void register_thread() {
+        buffer*& local = local_buffer();
+        if (local) {
+            return;
+        }
+        local = registry().with_locked([](std::vector<std::shared_ptr<buffer>>& buffers) {
+            buffers.push_back(std::make_shared<buffer>(static_cast<std::uint32_t>(buffers.size() + 1)));
+            return buffers.back().get();
+        });
+    }
+
+    //! Writes the events recorded since the previous write as a complete JSON trace.
+    static void write(std::ostream& os) {
+        registry().with_locked([&os](std::vector<std::shared_ptr<buffer>>& buffers) {
+            os << "{\"traceEvents\":[\n";
+            bool first = true;
+            for (auto& b : buffers) {
+                b->ring.drain([&](event const& e) {
+                    if (!first) {
+                        os << ",\n";
+                    }
+                    first = false;
+                    details::chrome::write_event(os, e, b->tid);
+                });
+            }
+            os << "\n]}\n";
+        });
+    }
+
+    //! Writes the events recorded since the previous write to the file at @a path.
+    static bool save(std::string const& path) {
+        std::ofstream file(path);
+        write(file);
+        return static_cast<bool>(file);
+    }
+
+    //! The number of events that were dropped because the buffer of their
+    //! thread was full, or could not be registered.
+    static std::uint64_t dropped() {
+        return std::as_const(registry()).with_locked([](std::vector<std::shared_ptr<buffer>> const& buffers) {
+            std::uint64_t total = unregistered_dropped().load(std::memory_order_relaxed);
+            for (auto const& b : buffers) {
+                total += b->ring.dropped();
+            }
+            return total;
+        });
+    }
+};
+
+} // end namespace llh::mutexed
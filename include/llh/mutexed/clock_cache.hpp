@@ -0,0 +1,291 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../mutexed.hpp"
+#include "sharding.hpp"
+
+namespace llh::mutexed {
+
+namespace details {
+
+/* The state of a shard of a clock_cache : a fixed array of slots swept by
+   the hand of the CLOCK algorithm, the free slots, and an index of the slots
+   by key.
+ */
+template<typename K, typename V, typename Hash, typename KeyEqual>
+class clock_shard {
+public:
+    struct entry {
+        K key;
+        V value;
+        // Set by the hits under a shared lock, cleared by the hand under an exclusive one.
+        std::atomic<bool> mutable referenced{false};
+
+        template<typename KK, typename VV>
+        entry(KK&& k, VV&& v) : key(std::forward<KK>(k)), value(std::forward<VV>(v)) {}
+    };
+
+private:
+    using index_type = std::unordered_map<K, std::size_t, Hash, KeyEqual>;
+
+    std::unique_ptr<std::optional<entry>[]> slots_;
+    std::size_t capacity_ = 0;
+    std::size_t hand_ = 0;
+    std::vector<std::size_t> free_;
+    index_type index_;
+
+    // Moves the hand to the first entry that is not referenced, clearing the bits on the way.
+    std::size_t sweep() {
+        while (slots_[hand_]->referenced.load(std::memory_order_relaxed)) {
+            slots_[hand_]->referenced.store(false, std::memory_order_relaxed);
+            hand_ = (hand_ + 1 == capacity_) ? 0 : hand_ + 1;
+        }
+        std::size_t const victim = hand_;
+        hand_ = (hand_ + 1 == capacity_) ? 0 : hand_ + 1;
+        return victim;
+    }
+
+public:
+    // Sets the number of slots of an empty shard, and the hasher of its index.
+    void set_capacity(std::size_t capacity, Hash const& hash) {
+        slots_ = std::make_unique<std::optional<entry>[]>(capacity);
+        capacity_ = capacity;
+        free_.reserve(capacity);
+        index_ = index_type(0, hash);
+        clear();
+        index_.reserve(capacity);
+    }
+
+    // Marks the entry of @a key as referenced and returns it, or returns null.
+    entry const* find(K const& key) const {
+        auto const it = index_.find(key);
+        if (it == index_.end()) {
+            return nullptr;
+        }
+        entry const& e = *slots_[it->second];
+        // Checking first keeps the hits on a hot entry from writing to its cache line.
+        if (!e.referenced.load(std::memory_order_relaxed)) {
+            e.referenced.store(true, std::memory_order_relaxed);
+        }
+        return &e;
+    }
+
+    entry* find(K const& key) {
+        return const_cast<entry*>(std::as_const(*this).find(key));
+    }
+
+    /* Inserts or assigns, evicting an entry if the shard is full. Returns
+       whether it inserted. If the new entry cannot be constructed or indexed,
+       its slot is freed, so that the evicted entry, if any, stays evicted.
+     */
+    template<typename KK, typename VV>
+    bool insert_or_assign(KK&& key, VV&& value) {
+        if (entry* e = find(key)) {
+            e->value = std::forward<VV>(value);
+            return false;
+        }
+        std::size_t slot;
+        if (!free_.empty()) {
+            slot = free_.back();
+            free_.pop_back();
+        } else {
+            slot = sweep();
+            index_.erase(slots_[slot]->key);
+            slots_[slot].reset();
+        }
+        try {
+            slots_[slot].emplace(std::forward<KK>(key), std::forward<VV>(value));
+            index_.emplace(slots_[slot]->key, slot);
+        } catch (...) {
+            // free_ has room for all the slots, so this does not allocate
+            slots_[slot].reset();
+            free_.push_back(slot);
+            throw;
+        }
+        return true;
+    }
+
+    bool erase(K const& key) {
+        auto const it = index_.find(key);
+        if (it == index_.end()) {
+            return false;
+        }
+        slots_[it->second].reset();
+        free_.push_back(it->second);
+        index_.erase(it);
+        return true;
+    }
+
+    void clear() {
+        free_.clear();
+        // In reverse so that the slots are used in order, as the hand sweeps them.
+        for (std::size_t i = capacity_; i-- > 0;) {
+            slots_[i].reset();
+            free_.push_back(i);
+        }
+        index_.clear();
+        hand_ = 0;
+    }
+
+    std::size_t size() const { return index_.size(); }
+};
+
+} // end namespace details
+
+/** A fixed-capacity cache split into shards, each one a Mutexed alone on its
+ *  cache line, which evicts with the CLOCK approximation of LRU.
+ *
+ * With a list-based LRU, every hit moves its entry to the front of the list,
+ * which requires an exclusive lock. Here a hit only sets the access bit of
+ * its entry, an atomic, under a shared lock of its shard when the mutex is
+ * @link llh::mutexed::shared_lockable shared_lockable @endlink, so that
+ * concurrent hits do not exclude each other. Inserting takes the exclusive
+ * lock of the shard, and when the shard is full, moves its hand over the
+ * entries, clearing their bit, until one is not set, which it evicts :
+ * ```cpp
+ * llh::mutexed::clock_cache<std::string, Response> responses(10'000);
+ *
+ * if (auto r = responses.find_copy(url)) {
+ *     return *r;
+ * }
+ * Response r = fetch(url);
+ * responses.insert_or_assign(url, r);
+ * ```
+ * Since each shard evicts on its own, the entries evicted are the least
+ * recently used of their shard rather than of the whole cache.
+ *
+ * @tparam K the type of the keys.
+ * @tparam V the type of the cached values.
+ * @tparam Hash the hash function of the keys, which also selects their shard,
+ *         and is copied into the index of each shard.
+ * @tparam KeyEqual the equality of the keys.
+ * @tparam M the type of the mutex of each shard.
+ */
+template<
+    typename K,
+    typename V,
+    typename Hash = std::hash<K>,
+    typename KeyEqual = std::equal_to<K>,
+    typename M = std::shared_mutex
+>
+class clock_cache {
+public:
+    using key_type = K;
+    using mapped_type = V;
+
+private:
+    using shard_state = details::clock_shard<K, V, Hash, KeyEqual>;
+    using shard_type = Mutexed<shard_state, M>;
+
+    std::size_t nb_shards_;
+    std::size_t shard_capacity_;
+    [[no_unique_address]] Hash hash_;
+    std::unique_ptr<details::cache_padded<shard_type>[]> shards_;
+
+    shard_type& shard_of(K const& key) const {
+        return shards_[details::shard_index(std::invoke(hash_, key), nb_shards_)].value;
+    }
+
+public:
+    /** Constructs an empty cache of at least @a capacity entries spread over
+     *  @a nb_shards shards, rounded up to a power of two, a few times the
+     *  number of hardware threads by default but no more than @a capacity,
+     *  which hash the keys with copies of @a hash.
+     */
+    explicit clock_cache(
+        std::size_t capacity,
+        std::size_t nb_shards = details::default_nb_shards(),
+        Hash const& hash = Hash{}
+    ) :
+        nb_shards_(std::bit_ceil(std::clamp<std::size_t>(nb_shards, 1, std::max<std::size_t>(1, capacity)))),
+        shard_capacity_(std::max<std::size_t>(1, (capacity + nb_shards_ - 1) / nb_shards_)),
+        hash_(hash),
+        shards_(std::make_unique<details::cache_padded<shard_type>[]>(nb_shards_))
+    {
+        for (std::size_t i = 0; i < nb_shards_; ++i) {
+            shards_[i].value.with_locked([this](shard_state& shard) { shard.set_capacity(shard_capacity_, hash_); });
+        }
+    }
+
+    clock_cache(clock_cache const&) = delete;
+    clock_cache(clock_cache&&) = delete;
+
+    //! The number of shards.
+    std::size_t nb_shards() const { return nb_shards_; }
+
+    //! The maximum number of entries, which may be a bit larger than the one requested.
+    std::size_t capacity() const { return nb_shards_ * shard_capacity_; }
+
+    /** Calls @a f with a `const` reference on the value cached for @a key, if
+     *  any, while locking its shard shared if possible, and marks it as used.
+     *
+     * The result is whether @a f was called if it returns `void`, and an
+     * `std::optional` of its decayed result otherwise.
+     */
+    template<typename F>
+    requires invokable_with<F, V const&>
+    auto with_value_locked(K const& key, F&& f) const -> details::try_result_t<std::invoke_result_t<F, V const&>> {
+        return std::as_const(shard_of(key)).with_locked([&key, &f](shard_state const& shard) {
+            auto const* e = shard.find(key);
+            return details::invoke_if(e ? &e->value : nullptr, std::forward<F>(f));
+        });
+    }
+
+    //! A copy of the value cached for @a key, if any, which is then marked as used.
+    std::optional<V> find_copy(K const& key) const {
+        return with_value_locked(key, [](V const& v) -> V const& { return v; });
+    }
+
+    /** Caches @a value for @a key, evicting an entry of its shard if it is
+     *  full, and returns whether the key was inserted rather than assigned.
+     *
+     * If constructing the new entry throws, the cache stays usable, without
+     * the new entry and without the one evicted for it, if any. A @a key that
+     * is not a `K` is converted once, and that `K` is both hashed and stored.
+     */
+    template<typename KK, typename VV>
+    requires std::is_constructible_v<K, KK&&> && std::is_constructible_v<V, VV&&> && std::is_assignable_v<V&, VV&&>
+    bool insert_or_assign(KK&& key, VV&& value) {
+        if constexpr (std::is_same_v<std::remove_cvref_t<KK>, K>) {
+            return shard_of(key).with_locked([&key, &value](shard_state& shard) {
+                return shard.insert_or_assign(std::forward<KK>(key), std::forward<VV>(value));
+            });
+        } else {
+            return insert_or_assign(K(std::forward<KK>(key)), std::forward<VV>(value));
+        }
+    }
+
+    //! Removes @a key, and returns whether it was cached.
+    bool erase(K const& key) {
+        return shard_of(key).with_locked([&key](shard_state& shard) { return shard.erase(key); });
+    }
+
+    //! Removes all the entries, one shard at a time.
+    void clear() {
+        for (std::size_t i = 0; i < nb_shards_; ++i) {
+            shards_[i].value.with_locked([](shard_state& shard) { shard.clear(); });
+        }
+    }
+
+    //! The number of entries, summed over the shards locked one at a time.
+    std::size_t size() const {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < nb_shards_; ++i) {
+            total += std::as_const(shards_[i].value).with_locked([](shard_state const& shard) { return shard.size(); });
+        }
+        return total;
+    }
+};
+
+} // end namespace llh::mutexed
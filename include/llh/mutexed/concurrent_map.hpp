@@ -0,0 +1,211 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "../mutexed.hpp"
+#include "sharding.hpp"
+
+namespace llh::mutexed {
+
+/** A hash map split into shards, each one a `std::unordered_map` in a Mutexed
+ *  alone on its cache line, so that the accesses to different keys seldom
+ *  contend.
+ *
+ * The accesses to a single key lock the shard of that key only, with a shared
+ * lock for the `const` ones when the mutex is @link llh::mutexed::shared_lockable
+ * shared_lockable @endlink, which lets the lookups scale :
+ * ```cpp
+ * llh::mutexed::concurrent_map<std::string, Session> sessions;
+ *
+ * sessions.insert_or_assign(id, Session{...});
+ * sessions.with_value_locked(id, [](Session& s) { s.touch(); });
+ * std::optional<Session> copy = sessions.find_copy(id);
+ * ```
+ * for_each() locks all the shards, in a fixed order, with the range form of
+ * with_all_locked(), which gives it a consistent view of the whole map.
+ *
+ * @tparam K the type of the keys.
+ * @tparam V the type of the mapped values.
+ * @tparam Hash the hash function of the keys, which also selects their shard,
+ *         and is copied into the map of each shard.
+ * @tparam KeyEqual the equality of the keys.
+ * @tparam M the type of the mutex of each shard.
+ */
+template<
+    typename K,
+    typename V,
+    typename Hash = std::hash<K>,
+    typename KeyEqual = std::equal_to<K>,
+    typename M = std::shared_mutex
+>
+class concurrent_map {
+public:
+    using key_type = K;
+    using mapped_type = V;
+    //! The type of the map of a shard
+    using map_type = std::unordered_map<K, V, Hash, KeyEqual>;
+    //! The type of a shard
+    using shard_type = Mutexed<map_type, M>;
+
+private:
+    std::size_t nb_shards_;
+    [[no_unique_address]] Hash hash_;
+    std::unique_ptr<details::cache_padded<shard_type>[]> shards_;
+
+    shard_type& shard_of(K const& key) const {
+        return shards_[details::shard_index(std::invoke(hash_, key), nb_shards_)].value;
+    }
+
+    // The shards as a range of Mutexed, const to lock them shared.
+    auto all_shards() {
+        return std::views::counted(shards_.get(), static_cast<std::ptrdiff_t>(nb_shards_))
+            | std::views::transform([](details::cache_padded<shard_type>& s) -> shard_type& { return s.value; });
+    }
+    auto all_shards() const {
+        return std::views::counted(shards_.get(), static_cast<std::ptrdiff_t>(nb_shards_))
+            | std::views::transform([](details::cache_padded<shard_type> const& s) -> shard_type const& { return s.value; });
+    }
+
+public:
+    /** Constructs an empty map of @a nb_shards shards, rounded up to a power of
+     *  two, a few times the number of hardware threads by default, which hash
+     *  the keys with copies of @a hash.
+     */
+    explicit concurrent_map(std::size_t nb_shards = details::default_nb_shards(), Hash const& hash = Hash{}) :
+        nb_shards_(std::bit_ceil(std::max<std::size_t>(1, nb_shards))),
+        hash_(hash),
+        shards_(std::make_unique<details::cache_padded<shard_type>[]>(nb_shards_))
+    {
+        for (shard_type& s : all_shards()) {
+            s.with_locked([this](map_type& map) { map = map_type(0, hash_); });
+        }
+    }
+
+    concurrent_map(concurrent_map const&) = delete;
+    concurrent_map(concurrent_map&&) = delete;
+
+    //! The number of shards.
+    std::size_t nb_shards() const { return nb_shards_; }
+
+    /** Calls @a f with a `const` reference on the value mapped to @a key, if
+     *  any, while locking its shard shared if possible.
+     *
+     * The result is whether @a f was called if it returns `void`, and an
+     * `std::optional` of its decayed result otherwise.
+     */
+    template<typename F>
+    requires invokable_with<F, V const&>
+    auto with_value_locked(K const& key, F&& f) const -> details::try_result_t<std::invoke_result_t<F, V const&>> {
+        return std::as_const(shard_of(key)).with_locked([&key, &f](map_type const& map) {
+            auto const it = map.find(key);
+            return details::invoke_if(it == map.end() ? nullptr : &it->second, std::forward<F>(f));
+        });
+    }
+
+    //! Same as the `const` with_value_locked() but with a reference on the value and an exclusive lock.
+    template<typename F>
+    requires invokable_with<F, V&>
+    auto with_value_locked(K const& key, F&& f) -> details::try_result_t<std::invoke_result_t<F, V&>> {
+        return shard_of(key).with_locked([&key, &f](map_type& map) {
+            auto const it = map.find(key);
+            return details::invoke_if(it == map.end() ? nullptr : &it->second, std::forward<F>(f));
+        });
+    }
+
+    /** Maps @a value to @a key, and returns whether the key was inserted rather than assigned.
+     *
+     * A @a key that is not a `K` is converted once, and that `K` is both hashed and stored.
+     */
+    template<typename KK, typename VV>
+    requires std::is_constructible_v<K, KK&&> && std::is_assignable_v<V&, VV&&>
+    bool insert_or_assign(KK&& key, VV&& value) {
+        if constexpr (std::is_same_v<std::remove_cvref_t<KK>, K>) {
+            return shard_of(key).with_locked([&key, &value](map_type& map) {
+                return map.insert_or_assign(std::forward<KK>(key), std::forward<VV>(value)).second;
+            });
+        } else {
+            return insert_or_assign(K(std::forward<KK>(key)), std::forward<VV>(value));
+        }
+    }
+
+    //! Constructs the value of @a key from @a args if the key is absent, and returns whether it did.
+    template<typename... Args>
+    requires std::is_constructible_v<V, Args&&...>
+    bool try_emplace(K const& key, Args&&... args) {
+        return shard_of(key).with_locked([&key, &args...](map_type& map) {
+            return map.try_emplace(key, std::forward<Args>(args)...).second;
+        });
+    }
+
+    //! Removes @a key, and returns whether it was present.
+    bool erase(K const& key) {
+        return shard_of(key).with_locked([&key](map_type& map) { return map.erase(key) != 0; });
+    }
+
+    //! A copy of the value mapped to @a key, if any.
+    std::optional<V> find_copy(K const& key) const {
+        return with_value_locked(key, [](V const& v) -> V const& { return v; });
+    }
+
+    //! Whether @a key is present, which may have changed once it returns.
+    bool contains(K const& key) const {
+        return std::as_const(shard_of(key)).with_locked([&key](map_type const& map) { return map.contains(key); });
+    }
+
+    /** The number of elements, summed over the shards locked one at a time,
+     *  which is exact only if the map is not modified meanwhile.
+     */
+    std::size_t size() const {
+        std::size_t total = 0;
+        for (shard_type const& s : all_shards()) {
+            total += s.with_locked([](map_type const& map) { return map.size(); });
+        }
+        return total;
+    }
+
+    //! Removes all the elements, one shard at a time.
+    void clear() {
+        for (shard_type& s : all_shards()) {
+            s.with_locked([](map_type& map) { map.clear(); });
+        }
+    }
+
+    /** Calls @a f with each key and `const` reference on its value, while all
+     *  the shards are locked shared if possible, so that it sees the map as a
+     *  whole at a single point in time.
+     */
+    template<typename F>
+    requires std::invocable<F&, K const&, V const&>
+    void for_each(F&& f) const {
+        with_all_locked([&f](std::span<std::reference_wrapper<map_type const>> maps) {
+            for (map_type const& map : maps) {
+                for (auto const& [key, value] : map) {
+                    std::invoke(f, key, value);
+                }
+            }
+        }, all_shards());
+    }
+
+    //! Same as the `const` for_each() but with references on the values and exclusive locks.
+    template<typename F>
+    requires std::invocable<F&, K const&, V&>
+    void for_each(F&& f) {
+        with_all_locked([&f](std::span<std::reference_wrapper<map_type>> maps) {
+            for (map_type& map : maps) {
+                for (auto& [key, value] : map) {
+                    std::invoke(f, key, value);
+                }
+            }
+        }, all_shards());
+    }
+};
+
+} // end namespace llh::mutexed
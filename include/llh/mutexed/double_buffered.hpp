@@ -0,0 +1,168 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <utility>
+
+#include "../mutexed.hpp"
+
+namespace llh::mutexed {
+
+//! Checks if T is a container that can be drained by DoubleBufferedMutexed.
+template<typename T>
+concept double_bufferable = std::is_default_constructible_v<T> && std::is_swappable_v<T> &&
+    requires(T& t, T const& ct) {
+        t.clear();
+        { ct.empty() } -> std::convertible_to<bool>;
+    };
+
+/** A pair of buffers for handing batches over from producers to consumers, in
+ *  which the producers append to a front buffer under a short lock and the
+ *  consumers process a back buffer without blocking them.
+ *
+ * Consuming flips the buffers by swapping the front one with the back one
+ * once it has been cleared, which only holds the lock of the front buffer for
+ * a swap, and the batch is processed with that lock released. Both buffers
+ * keep their capacity across the flips, so that a steady stream of batches of
+ * similar sizes does not allocate :
+ * ```cpp
+ * llh::mutexed::DoubleBufferedMutexed<std::vector<LogLine>> logs;
+ *
+ * // producers
+ * logs.push(LogLine{...});
+ *
+ * // consumer
+ * while (running) {
+ *     logs.wait_and_consume_for(100ms, [](std::vector<LogLine>& batch) { write(batch); });
+ * }
+ * ```
+ * The front buffer is a Mutexed that has_cv, which makes the waits of the
+ * consumers the ones of Mutexed, made without holding any lock. The back
+ * buffer is a Mutexed as well, locked from the flip until the batch is
+ * processed, so that several consumers take turns, each one processing its
+ * own batch. That lock is never taken by the producers, which are not
+ * blocked, but another consumer that wants to flip the buffers again waits
+ * for the batch to be processed.
+ *
+ * @tparam T the type of the buffers, a container that has `clear()` and `empty()`.
+ * @tparam M the type of the mutex of the front buffer.
+ */
+template<double_bufferable T, typename M = std::mutex>
+class DoubleBufferedMutexed {
+private:
+    Mutexed<T, M, has_cv> front_;
+    // Locked before front_ by the consumers, and never by the producers.
+    Mutexed<T, std::mutex> back_;
+
+    static bool not_empty(T const& buffer) { return !buffer.empty(); }
+
+    template<typename F>
+    decltype(auto) flip_and_process(F&& f) {
+        return back_.with_locked([this, &f](T& back) -> decltype(auto) {
+            front_.drain_into(back);
+            return std::invoke(std::forward<F>(f), back);
+        });
+    }
+
+    // Flips the buffers if the front one is not empty, with the back one locked.
+    bool flip_if_not_empty(T& back) {
+        back.clear();
+        return front_.with_locked_if(&not_empty, [&back](T& front) {
+            using std::swap;
+            swap(front, back);
+        });
+    }
+
+    /* Same as flip_and_process() once the front buffer is not empty. The wait
+       holds no lock, and another consumer may take the batch before the back
+       buffer is locked, in which case it waits again.
+     */
+    template<typename F>
+    decltype(auto) wait_flip_and_process(F&& f) {
+        while (true) {
+            front_.wait(&not_empty);
+            auto [lock, back] = back_.locked();
+            if (flip_if_not_empty(back)) {
+                return std::invoke(std::forward<F>(f), back);
+            }
+        }
+    }
+
+public:
+    //! The type of the buffers
+    using value_type = T;
+
+    //! Default-constructs both buffers.
+    DoubleBufferedMutexed() = default;
+
+    DoubleBufferedMutexed(DoubleBufferedMutexed const&) = delete;
+    DoubleBufferedMutexed(DoubleBufferedMutexed&&) = delete;
+
+    /** Calls @a f with a reference on the front buffer while locking it, and
+     *  notifies the consumers waiting for it afterwards.
+     */
+    template<typename F>
+    requires invokable_with<F, T&>
+    decltype(auto) produce(F&& f) {
+        return front_.with_locked(std::forward<F>(f));
+    }
+
+    //! Appends @a value to the front buffer with its `push_back()`.
+    template<typename U>
+    requires requires(T& t, U&& u) { t.push_back(std::forward<U>(u)); }
+    void push(U&& value) {
+        front_.with_locked([&value](T& front) { front.push_back(std::forward<U>(value)); });
+    }
+
+    /** Flips the buffers and calls @a f with a reference on the batch that was
+     *  in the front buffer, which may be empty, while locking the back buffer.
+     *
+     * The producers are not blocked meanwhile, the other consumers are. The
+     * batch is cleared by the next flip, so @a f may move its elements out or
+     * leave them there.
+     */
+    template<typename F>
+    requires invokable_with<F, T&>
+    decltype(auto) consume(F&& f) {
+        return flip_and_process(std::forward<F>(f));
+    }
+
+    /** Same as consume() after waiting for the front buffer not to be empty,
+     *  so that the batch is never empty, even with several consumers.
+     */
+    template<typename F>
+    requires invokable_with<F, T&>
+    decltype(auto) wait_and_consume(F&& f) {
+        return wait_flip_and_process(std::forward<F>(f));
+    }
+
+    /** Same as wait_and_consume() if the front buffer is not empty within
+     *  @a rel_time.
+     *
+     * The result is whether @a f was called if it returns `void`, and an
+     * `std::optional` of its decayed result otherwise. The time spent waiting
+     * for another consumer to process its batch is not bounded by @a rel_time.
+     */
+    template<class Rep, class Period, typename F>
+    requires invokable_with<F, T&>
+    auto wait_and_consume_for(std::chrono::duration<Rep, Period> const& rel_time, F&& f)
+        -> details::try_result_t<std::invoke_result_t<F, T&>>
+    {
+        auto const timeout_time = std::chrono::steady_clock::now() + rel_time;
+        while (front_.wait_until(timeout_time, &not_empty)) {
+            auto [lock, back] = back_.locked();
+            if (flip_if_not_empty(back)) {
+                return details::invoke_if(&back, std::forward<F>(f));
+            }
+        }
+        return {};
+    }
+
+    //! Whether the front buffer is empty, which may have changed once it returns.
+    bool empty() const {
+        return front_.with_locked([](T const& front) { return front.empty(); });
+    }
+};
+
+} // end namespace llh::mutexed
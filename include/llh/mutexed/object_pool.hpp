@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "../mutexed.hpp"
+#include "sharding.hpp"
+
+namespace llh::mutexed {
+
+/** A pool of reusable heap-allocated objects, with a small cache per thread
+ *  in front of a shared depot, so that the depot, a single Mutexed, is only
+ *  locked once every `BatchSize` acquisitions or releases.
+ *
+ * Each thread acquires from and releases to the cache of its stripe, which is
+ * a Mutexed alone on its cache line and not contended unless there are more
+ * threads than stripes. A cache that is empty takes a batch of `BatchSize`
+ * objects from the depot, and a cache that holds `2 * BatchSize` objects moves
+ * a batch to it, so that a thread that alternates acquisitions and releases
+ * does not reach the depot at all :
+ * ```cpp
+ * llh::mutexed::object_pool<Buffer> buffers;
+ *
+ * std::unique_ptr<Buffer> b = buffers.acquire();
+ * // ...
+ * buffers.release(std::move(b));
+ * ```
+ * The objects are released as they are, so a caller that needs them in a
+ * given state resets them, before the release or after the acquisition.
+ *
+ * @tparam T the type of the objects.
+ * @tparam BatchSize the number of objects exchanged with the depot at once.
+ * @tparam M the type of the mutexes of the caches and of the depot.
+ */
+template<typename T, std::size_t BatchSize = 32, typename M = std::mutex>
+requires (BatchSize > 0)
+class object_pool {
+public:
+    using value_type = T;
+    //! The number of objects exchanged with the depot at once
+    static constexpr std::size_t batch_size = BatchSize;
+
+private:
+    using objects = std::vector<std::unique_ptr<T>>;
+    using cache_type = Mutexed<objects, M>;
+
+    std::size_t nb_stripes_;
+    std::unique_ptr<details::cache_padded<cache_type>[]> caches_;
+    // Locked after a cache, never before.
+    Mutexed<objects, M> depot_;
+
+    cache_type& own_cache() {
+        return caches_[details::thread_stripe() & (nb_stripes_ - 1)].value;
+    }
+
+    // Moves up to @a nb objects from the back of @a from to the back of @a to.
+    static void move_back(objects& from, objects& to, std::size_t nb) {
+        auto const first = from.end() - static_cast<std::ptrdiff_t>(std::min(nb, from.size()));
+        to.insert(to.end(), std::make_move_iterator(first), std::make_move_iterator(from.end()));
+        from.erase(first, from.end());
+    }
+
+public:
+    /** Constructs an empty pool with @a nb_stripes caches, rounded up to a
+     *  power of two, a few times the number of hardware threads by default.
+     */
+    explicit object_pool(std::size_t nb_stripes = details::default_nb_shards()) :
+        nb_stripes_(std::bit_ceil(std::max<std::size_t>(1, nb_stripes))),
+        caches_(std::make_unique<details::cache_padded<cache_type>[]>(nb_stripes_))
+    {
+        for (std::size_t i = 0; i < nb_stripes_; ++i) {
+            caches_[i].value.with_locked([](objects& cache) { cache.reserve(2 * BatchSize); });
+        }
+    }
+
+    object_pool(object_pool const&) = delete;
+    object_pool(object_pool&&) = delete;
+
+    //! The number of caches.
+    std::size_t nb_stripes() const { return nb_stripes_; }
+
+    /** A pooled object, or the result of @a make, such as a `std::unique_ptr<T>`,
+     *  if the pool is empty.
+     */
+    template<typename F>
+    requires std::is_convertible_v<std::invoke_result_t<F>, std::unique_ptr<T>>
+    std::unique_ptr<T> acquire(F&& make) {
+        std::unique_ptr<T> pooled = own_cache().with_locked([this](objects& cache) {
+            if (cache.empty()) {
+                depot_.with_locked([&cache](objects& depot) { move_back(depot, cache, BatchSize); });
+                if (cache.empty()) {
+                    return std::unique_ptr<T>();
+                }
+            }
+            std::unique_ptr<T> last = std::move(cache.back());
+            cache.pop_back();
+            return last;
+        });
+        if (!pooled) {
+            // The construction happens with no lock held.
+            return std::invoke(std::forward<F>(make));
+        }
+        return pooled;
+    }
+
+    //! A pooled object, or a value-initialized one if the pool is empty.
+    std::unique_ptr<T> acquire() requires std::is_default_constructible_v<T> {
+        return acquire([] { return std::make_unique<T>(); });
+    }
+
+    //! Gives @a obj back to the pool, or does nothing if it is null.
+    void release(std::unique_ptr<T> obj) {
+        if (!obj) {
+            return;
+        }
+        own_cache().with_locked([this, &obj](objects& cache) {
+            if (cache.size() == 2 * BatchSize) {
+                depot_.with_locked([&cache](objects& depot) { move_back(cache, depot, BatchSize); });
+            }
+            cache.push_back(std::move(obj));
+        });
+    }
+
+    //! The number of pooled objects, counted with the caches and the depot locked one at a time.
+    std::size_t size() const {
+        std::size_t total = depot_.with_locked([](objects const& depot) { return depot.size(); });
+        for (std::size_t i = 0; i < nb_stripes_; ++i) {
+            total += std::as_const(caches_[i].value).with_locked([](objects const& cache) { return cache.size(); });
+        }
+        return total;
+    }
+
+    //! Destroys the pooled objects, after having moved them out of the locks.
+    void clear() {
+        objects garbage;
+        for (std::size_t i = 0; i < nb_stripes_; ++i) {
+            caches_[i].value.with_locked([&garbage](objects& cache) { move_back(cache, garbage, cache.size()); });
+        }
+        depot_.with_locked([&garbage](objects& depot) { move_back(depot, garbage, depot.size()); });
+    }
+};
+
+} // end namespace llh::mutexed
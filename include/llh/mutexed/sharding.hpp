@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+
+namespace llh::mutexed::details {
+
+/* The helpers of the components that split their state into shards, each one
+   protected by its own Mutexed so that threads touching different shards do
+   not contend.
+ */
+
+/* The alignment that keeps two shards from sharing a cache line.
+   `std::hardware_destructive_interference_size` is not used since its value
+   may differ between translation units built with different flags.
+ */
+inline constexpr std::size_t cache_line_size = 64;
+
+//! A @a T alone on its cache lines.
+template<typename T>
+struct alignas(cache_line_size) cache_padded {
+    T value;
+};
+
+/* A fixed number of cache_padded @a T in a single allocation, each one
+   constructed in place from the same arguments, so that @a T needs to be
+   neither default-constructible nor movable, as a Mutexed is not.
+ */
+template<typename T>
+class padded_array {
+private:
+    using allocator = std::allocator<cache_padded<T>>;
+
+    std::size_t size_;
+    cache_padded<T>* data_;
+
+    void destroy(std::size_t nb_constructed) noexcept {
+        std::destroy_n(data_, nb_constructed);
+        allocator().deallocate(data_, size_);
+    }
+
+public:
+    template<typename... Args>
+    padded_array(std::size_t size, Args const&... args) :
+        size_(size),
+        data_(allocator().allocate(size))
+    {
+        std::size_t i = 0;
+        try {
+            for (; i < size_; ++i) {
+                // The braces construct the prvalue in place, with no move.
+                ::new (static_cast<void*>(data_ + i)) cache_padded<T>{T(args...)};
+            }
+        } catch (...) {
+            destroy(i);
+            throw;
+        }
+    }
+
+    ~padded_array() { destroy(size_); }
+
+    padded_array(padded_array const&) = delete;
+    padded_array& operator=(padded_array const&) = delete;
+
+    cache_padded<T>& operator[](std::size_t i) { return data_[i]; }
+    cache_padded<T> const& operator[](std::size_t i) const { return data_[i]; }
+
+    cache_padded<T>* get() { return data_; }
+    cache_padded<T> const* get() const { return data_; }
+};
+
+//! A power of two a few times larger than the number of hardware threads.
+inline std::size_t default_nb_shards() {
+    return std::bit_ceil(4 * std::max<std::size_t>(1, std::thread::hardware_concurrency()));
+}
+
+//! The stripe of the calling thread, assigned in turns at its first use so that threads spread evenly.
+inline std::size_t thread_stripe() {
+    static std::atomic<std::size_t> next{0};
+    thread_local std::size_t const stripe = next.fetch_add(1, std::memory_order_relaxed);
+    return stripe;
+}
+
+/* The shard of @a hash among @a nb_shards, a power of two. The hash is
+   mixed and its high bits are used, so that the shard does not depend on
+   the same bits as the bucket of a hash table inside the shard.
+ */
+inline std::size_t shard_index(std::size_t hash, std::size_t nb_shards) {
+    std::uint64_t const mixed = static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+    return nb_shards == 1 ? 0 : static_cast<std::size_t>(mixed >> (64 - std::countr_zero(nb_shards)));
+}
+
+} // end namespace llh::mutexed::details
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ranges>
+#include <span>
+#include <utility>
+
+#include "../mutexed.hpp"
+#include "sharding.hpp"
+
+namespace llh::mutexed {
+
+/** A value made of partial values, one per stripe, each one a Mutexed alone
+ *  on its cache line, for write-heavy and read-rarely accumulations such as
+ *  counters and statistics.
+ *
+ * A thread always writes to the same stripe, so that unless there are more
+ * threads than stripes, the mutex of a stripe is never contended and its
+ * cache line stays with a single core. Reading reduces all the partial values :
+ * ```cpp
+ * struct Stats { std::int64_t nb = 0; std::int64_t total = 0; };
+ * auto merge = [](Stats a, Stats const& b) { return Stats{a.nb + b.nb, a.total + b.total}; };
+ *
+ * llh::mutexed::striped_accumulator<Stats, decltype(merge)> stats;
+ * stats.with_locked([latency](Stats& s) { ++s.nb; s.total += latency; });
+ * Stats const all = stats.get_copy();
+ * ```
+ * This only holds if the updates commute, since the value read is the
+ * reduction of the partial values, which are each updated in their own order.
+ *
+ * @tparam T the type of the value, and of the partial values.
+ * @tparam Reduce the binary function that merges two partial values, which is
+ *         associative and commutative, and whose identity is given at construction.
+ * @tparam M the type of the mutex of each stripe.
+ */
+template<typename T, typename Reduce = std::plus<T>, typename M = std::mutex>
+requires std::is_invocable_r_v<T, Reduce const&, T&&, T const&> && std::is_copy_constructible_v<T>
+class striped_accumulator {
+public:
+    using value_type = T;
+
+private:
+    using stripe_type = Mutexed<T, M>;
+
+    T identity_;
+    [[no_unique_address]] Reduce reduce_;
+    std::size_t nb_stripes_;
+    details::padded_array<stripe_type> stripes_;
+
+    stripe_type& own_stripe() {
+        return stripes_[details::thread_stripe() & (nb_stripes_ - 1)].value;
+    }
+
+    // The stripes as a range of Mutexed, const to lock them shared.
+    auto all_stripes() {
+        return std::views::counted(stripes_.get(), static_cast<std::ptrdiff_t>(nb_stripes_))
+            | std::views::transform([](details::cache_padded<stripe_type>& s) -> stripe_type& { return s.value; });
+    }
+    auto all_stripes() const {
+        return std::views::counted(stripes_.get(), static_cast<std::ptrdiff_t>(nb_stripes_))
+            | std::views::transform([](details::cache_padded<stripe_type> const& s) -> stripe_type const& { return s.value; });
+    }
+
+    template<typename Ref>
+    T reduce_all(std::span<Ref> partials) const {
+        T result = identity_;
+        for (T const& partial : partials) {
+            result = std::invoke(reduce_, std::move(result), partial);
+        }
+        return result;
+    }
+
+public:
+    /** Constructs @a nb_stripes stripes, rounded up to a power of two, a few
+     *  times the number of hardware threads by default, whose partial values
+     *  are copy-constructed from @a identity.
+     */
+    explicit striped_accumulator(
+        T const& identity = T{},
+        Reduce reduce = Reduce{},
+        std::size_t nb_stripes = details::default_nb_shards()
+    ) :
+        identity_(identity),
+        reduce_(std::move(reduce)),
+        nb_stripes_(std::bit_ceil(std::max<std::size_t>(1, nb_stripes))),
+        stripes_(nb_stripes_, identity_)
+    {}
+
+    striped_accumulator(striped_accumulator const&) = delete;
+    striped_accumulator(striped_accumulator&&) = delete;
+
+    //! The number of stripes.
+    std::size_t nb_stripes() const { return nb_stripes_; }
+
+    /** Calls @a f with a reference on the partial value of the calling thread
+     *  while locking its stripe, which must be an update that commutes with
+     *  the other ones.
+     */
+    template<typename F>
+    requires invokable_with<F, T&>
+    decltype(auto) with_locked(F&& f) {
+        return own_stripe().with_locked(std::forward<F>(f));
+    }
+
+    //! Merges @a value into the partial value of the calling thread with the reduce function.
+    void add(T const& value) {
+        own_stripe().with_locked([this, &value](T& partial) {
+            partial = std::invoke(reduce_, std::move(partial), value);
+        });
+    }
+
+    /** The reduction of all the partial values, which are locked together,
+     *  shared if possible, so that it is the value at a single point in time.
+     */
+    T get_copy() const {
+        return with_all_locked([this](std::span<std::reference_wrapper<T const>> partials) {
+            return reduce_all(partials);
+        }, all_stripes());
+    }
+
+    //! Same as get_copy(), and resets all the partial values to the identity under the same lock.
+    T take() {
+        return with_all_locked([this](std::span<std::reference_wrapper<T>> partials) {
+            T result = reduce_all(partials);
+            for (T& partial : partials) {
+                partial = identity_;
+            }
+            return result;
+        }, all_stripes());
+    }
+};
+
+} // end namespace llh::mutexed
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+#include "../mutexed.hpp"
+
+namespace llh::mutexed {
+
+/** A shared mutex with a third, <em>upgrade</em>, ownership that coexists with
+ *  shared owners but not with another upgrade owner nor with an exclusive one,
+ *  and that can be turned into an exclusive ownership without being released.
+ *
+ * It is @link llh::mutexed::upgrade_lockable upgrade_lockable @endlink, which
+ * makes Mutexed::with_upgradeable_locked() available :
+ * ```cpp
+ * llh::mutexed::Mutexed<Cache, llh::mutexed::upgrade_mutex> cache;
+ * ```
+ * Since a single thread at a time holds the upgrade ownership, the upgrade
+ * cannot deadlock : it waits for the readers to leave while no new one enters.
+ *
+ * The whole state is a single word protected by an internal `std::mutex`, after
+ * the design proposed by Howard Hinnant for the standard's `upgrade_mutex`.
+ * It is not a capability of Clang's thread-safety analysis, which has no
+ * ownership that coexists with the shared ones as the upgrade one does.
+ */
+class upgrade_mutex {
+private:
+    static constexpr std::uint32_t write_entered = 1u << 31;
+    static constexpr std::uint32_t upgrade_entered = 1u << 30;
+    static constexpr std::uint32_t nb_readers_mask = ~(write_entered | upgrade_entered);
+
+    std::mutex mtx_;
+    // Where the threads that want to enter wait.
+    std::condition_variable gate1_;
+    // Where the exclusive owner waits for the readers to leave.
+    std::condition_variable gate2_;
+    // The number of shared owners, the upgrade owner included, and the two flags.
+    std::uint32_t state_ = 0;
+
+    std::uint32_t nb_readers() const { return state_ & nb_readers_mask; }
+
+    bool can_enter_shared() const {
+        return !(state_ & write_entered) && nb_readers() != nb_readers_mask;
+    }
+    bool can_enter_upgrade() const {
+        return !(state_ & (write_entered | upgrade_entered)) && nb_readers() != nb_readers_mask;
+    }
+
+    // Sets the exclusive flag once no other thread can, and waits for the readers to leave.
+    void enter_exclusive(std::unique_lock<std::mutex>& lock) {
+        state_ |= write_entered;
+        gate2_.wait(lock, [this] { return nb_readers() == 0; });
+    }
+
+public:
+    upgrade_mutex() = default;
+    upgrade_mutex(upgrade_mutex const&) = delete;
+    upgrade_mutex& operator=(upgrade_mutex const&) = delete;
+
+    void lock() {
+        std::unique_lock lock(mtx_);
+        gate1_.wait(lock, [this] { return !(state_ & (write_entered | upgrade_entered)); });
+        enter_exclusive(lock);
+    }
+    bool try_lock() {
+        std::lock_guard lock(mtx_);
+        if (state_ != 0) {
+            return false;
+        }
+        state_ = write_entered;
+        return true;
+    }
+    void unlock() {
+        {
+            std::lock_guard lock(mtx_);
+            state_ = 0;
+        }
+        gate1_.notify_all();
+    }
+
+    void lock_shared() {
+        std::unique_lock lock(mtx_);
+        gate1_.wait(lock, [this] { return can_enter_shared(); });
+        ++state_;
+    }
+    bool try_lock_shared() {
+        std::lock_guard lock(mtx_);
+        if (!can_enter_shared()) {
+            return false;
+        }
+        ++state_;
+        return true;
+    }
+    void unlock_shared() {
+        std::unique_lock lock(mtx_);
+        bool const was_full = nb_readers() == nb_readers_mask;
+        --state_;
+        bool const last_before_writer = (state_ & write_entered) && nb_readers() == 0;
+        lock.unlock();
+        if (last_before_writer) {
+            gate2_.notify_one();
+        } else if (was_full) {
+            gate1_.notify_all();
+        }
+    }
+
+    //! Acquires the upgrade ownership, which is shared with the readers.
+    void lock_upgrade() {
+        std::unique_lock lock(mtx_);
+        gate1_.wait(lock, [this] { return can_enter_upgrade(); });
+        state_ = (state_ | upgrade_entered) + 1;
+    }
+    bool try_lock_upgrade() {
+        std::lock_guard lock(mtx_);
+        if (!can_enter_upgrade()) {
+            return false;
+        }
+        state_ = (state_ | upgrade_entered) + 1;
+        return true;
+    }
+    void unlock_upgrade() {
+        {
+            std::lock_guard lock(mtx_);
+            state_ = (state_ & ~upgrade_entered) - 1;
+        }
+        gate1_.notify_all();
+    }
+
+    //! Turns the upgrade ownership into an exclusive one, waiting for the readers to leave.
+    void unlock_upgrade_and_lock() {
+        std::unique_lock lock(mtx_);
+        state_ = (state_ & ~upgrade_entered) - 1;
+        enter_exclusive(lock);
+    }
+    //! Turns the exclusive ownership into an upgrade one, letting the readers in.
+    void unlock_and_lock_upgrade() {
+        {
+            std::lock_guard lock(mtx_);
+            state_ = upgrade_entered | 1;
+        }
+        gate1_.notify_all();
+    }
+    //! Turns the exclusive ownership into a shared one, letting the readers in.
+    void unlock_and_lock_shared() {
+        {
+            std::lock_guard lock(mtx_);
+            state_ = 1;
+        }
+        gate1_.notify_all();
+    }
+    //! Turns the upgrade ownership into a shared one, letting another upgrader in.
+    void unlock_upgrade_and_lock_shared() {
+        {
+            std::lock_guard lock(mtx_);
+            state_ &= ~upgrade_entered;
+        }
+        gate1_.notify_all();
+    }
+};
+
+} // end namespace llh::mutexed
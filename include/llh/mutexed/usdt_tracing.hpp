@@ -0,0 +1,56 @@
+#pragma once
+
+#include "../mutexed.hpp"
+
+namespace llh::mutexed {
+
+/** A tracing policy for traced_mutex that fires the Linux USDT probes of the
+ *  provider `llh_mutexed`, which cost a `nop` while nothing is attached to
+ *  them.
+ *
+ * Like the probes of Mutexed, they are only compiled in when `LLH_MUTEXED_USDT`
+ * is defined before including the library, preferably on the command line, and
+ * `<sys/sdt.h>` (systemtap-sdt-dev) is available.
+ *
+ * Every hook of tracing_policy has a probe of the same name prefixed with
+ * `mutex_`, whose first argument is the address of the traced_mutex and whose
+ * second argument, except for `mutex_notify`, is 1 for a shared lock and 0 for
+ * an exclusive one. The prefix tells them apart from the probes of Mutexed,
+ * which fire at the same time with the address of the Mutexed. For instance,
+ * counting the stacks of contended acquisitions of a running process :
+ * ```sh
+ * bpftrace -p <pid> -e 'usdt:*:llh_mutexed:mutex_contended { @[ustack] = count(); }'
+ * ```
+ */
+struct usdt_tracer : tracing_policy {
+    //! Whether the probes are emitted, see LLH_MUTEXED_USDT.
+#ifdef LLH_MUTEXED_USDT_ENABLED
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+
+    static void acquire_begin([[maybe_unused]] void const* mtx, [[maybe_unused]] lock_mode mode) noexcept {
+        LLH_MUTEXED_USDT_PROBE(mutex_acquire_begin, mtx, mode);
+    }
+    static void contended([[maybe_unused]] void const* mtx, [[maybe_unused]] lock_mode mode) noexcept {
+        LLH_MUTEXED_USDT_PROBE(mutex_contended, mtx, mode);
+    }
+    static void acquire_end([[maybe_unused]] void const* mtx, [[maybe_unused]] lock_mode mode) noexcept {
+        LLH_MUTEXED_USDT_PROBE(mutex_acquire_end, mtx, mode);
+    }
+    static void release([[maybe_unused]] void const* mtx, [[maybe_unused]] lock_mode mode) noexcept {
+        LLH_MUTEXED_USDT_PROBE(mutex_release, mtx, mode);
+    }
+    static void notify([[maybe_unused]] void const* mtx) noexcept {
+        LLH_MUTEXED_USDT_PROBE1(mutex_notify, mtx);
+    }
+    static void wait_begin([[maybe_unused]] void const* mtx, [[maybe_unused]] lock_mode mode) noexcept {
+        LLH_MUTEXED_USDT_PROBE(mutex_wait_begin, mtx, mode);
+    }
+    static void wait_end([[maybe_unused]] void const* mtx, [[maybe_unused]] lock_mode mode) noexcept {
+        LLH_MUTEXED_USDT_PROBE(mutex_wait_end, mtx, mode);
+    }
+};
+
+} // end namespace llh::mutexed
@@ -0,0 +1,205 @@
+#define BOOST_TEST_MODULE BoundedQueue
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mutexed/bounded_queue.hpp"
+
+using namespace llh::mutexed;
+
+static_assert(queue_storage<ring_buffer<int>>);
+static_assert(queue_storage<std::deque<int>>);
+static_assert(!queue_storage<std::vector<int>>);
+
+
+BOOST_AUTO_TEST_SUITE(RingBufferTests)
+
+BOOST_AUTO_TEST_CASE(WrapsAround)
+{
+    ring_buffer<std::string> ring;
+    ring.reserve(3);
+    BOOST_TEST(ring.capacity() == 3u);
+
+    for (int round = 0; round < 5; ++round) {
+        ring.push_back(std::to_string(2 * round));
+        ring.push_back(std::to_string(2 * round + 1));
+        BOOST_TEST(ring.size() == 2u);
+        BOOST_TEST(ring.front() == std::to_string(2 * round));
+        ring.pop_front();
+        BOOST_TEST(ring.front() == std::to_string(2 * round + 1));
+        ring.pop_front();
+        BOOST_TEST(ring.empty());
+    }
+
+    // reallocating keeps the order of the elements
+    ring.push_back("a");
+    ring.push_back("b");
+    ring.pop_front();
+    ring.push_back("c");
+    ring.push_back("d");
+    ring.reserve(8);
+    BOOST_TEST(ring.capacity() == 8u);
+    for (char const* expected : {"b", "c", "d"}) {
+        BOOST_TEST(ring.front() == expected);
+        ring.pop_front();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(DestroysElements)
+{
+    auto counted = std::make_shared<int>(0);
+    {
+        ring_buffer<std::shared_ptr<int>> ring;
+        ring.reserve(4);
+        ring.push_back(counted);
+        ring.push_back(counted);
+        BOOST_TEST(counted.use_count() == 3);
+        ring.pop_front();
+        BOOST_TEST(counted.use_count() == 2);
+    }
+    BOOST_TEST(counted.use_count() == 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+
+BOOST_AUTO_TEST_SUITE(BoundedQueueTests)
+
+BOOST_AUTO_TEST_CASE(TryPushAndPop)
+{
+    bounded_queue<std::unique_ptr<int>> queue(2);
+    BOOST_TEST(queue.capacity() == 2u);
+    BOOST_TEST(queue.empty());
+    BOOST_TEST(!queue.try_pop());
+
+    BOOST_TEST(queue.try_push(std::make_unique<int>(1)));
+    BOOST_TEST(queue.try_push(std::make_unique<int>(2)));
+    auto third = std::make_unique<int>(3);
+    BOOST_TEST(!queue.try_push(std::move(third)));
+    // a failed push does not move from its argument
+    BOOST_TEST(third != nullptr);
+    BOOST_TEST(queue.size() == 2u);
+
+    BOOST_TEST(*queue.pop() == 1);
+    BOOST_TEST(*queue.try_pop().value() == 2);
+    BOOST_TEST(queue.empty());
+}
+
+BOOST_AUTO_TEST_CASE(TimedVariants)
+{
+    bounded_queue<int> queue(1);
+
+    BOOST_TEST(!queue.try_pop_for(std::chrono::milliseconds(10)));
+    BOOST_TEST(queue.try_push_for(std::chrono::milliseconds(10), 1));
+    BOOST_TEST(!queue.try_push_for(std::chrono::milliseconds(10), 2));
+    BOOST_TEST(!queue.try_push_until(std::chrono::steady_clock::now() + std::chrono::milliseconds(10), 2));
+
+    int popped = 0;
+    std::thread consumer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        popped = queue.pop();
+    });
+    BOOST_TEST(queue.try_push_for(std::chrono::seconds(10), 2));
+    consumer.join();
+    BOOST_TEST(popped == 1);
+
+    BOOST_TEST(queue.try_pop_until(std::chrono::steady_clock::now() + std::chrono::seconds(10)).value() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(Batches)
+{
+    bounded_queue<int, std::mutex, std::deque<int>> queue(4);
+    std::vector<int> const in{1, 2, 3, 4, 5, 6};
+
+    BOOST_TEST(queue.try_push_n(in.begin(), in.end()) == 4u);
+
+    std::vector<int> out;
+    BOOST_TEST(queue.try_pop_n(std::back_inserter(out), 3) == 3u);
+    BOOST_TEST(out == std::vector<int>({1, 2, 3}));
+    BOOST_TEST(queue.try_pop_n_for(std::chrono::milliseconds(10), std::back_inserter(out), 3) == 1u);
+    BOOST_TEST(queue.try_pop_n_for(std::chrono::milliseconds(10), std::back_inserter(out), 3) == 0u);
+
+    // a batch larger than the capacity goes through as the consumer makes room
+    std::vector<int> big(10);
+    for (int i = 0; i < 10; ++i) { big[static_cast<std::size_t>(i)] = i; }
+    std::thread producer([&]() { queue.push_n(big.begin(), big.end()); });
+    std::vector<int> received;
+    while (received.size() < big.size()) {
+        queue.pop_n(std::back_inserter(received), 3);
+    }
+    producer.join();
+    BOOST_TEST(received == big);
+}
+
+BOOST_AUTO_TEST_CASE(BlockedPopWakesUp)
+{
+    bounded_queue<int> queue(4);
+    std::atomic<int> sum = 0;
+
+    std::vector<std::thread> consumers;
+    for (int i = 0; i < 3; ++i) {
+        consumers.emplace_back([&]() { sum += queue.pop(); });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    // one batch wakes up as many consumers as it has elements
+    std::vector<int> const in{1, 2, 3};
+    queue.push_n(in.begin(), in.end());
+    for (auto& c : consumers) {
+        c.join();
+    }
+    BOOST_TEST(sum == 6);
+}
+
+BOOST_AUTO_TEST_CASE(ProducersAndConsumers)
+{
+    bounded_queue<int> queue(8);
+    constexpr int nb_producers = 3;
+    constexpr int nb_consumers = 3;
+    constexpr int nb_items = 2000;
+    std::atomic<long> sum = 0;
+
+    std::vector<std::thread> threads;
+    for (int c = 0; c < nb_consumers; ++c) {
+        threads.emplace_back([&, c]() {
+            std::vector<int> batch;
+            int received = 0;
+            while (received < nb_items) {
+                if (c == 0) {
+                    sum += queue.pop();
+                    ++received;
+                } else {
+                    batch.clear();
+                    received += static_cast<int>(queue.pop_n(std::back_inserter(batch), nb_items - received));
+                    for (int v : batch) { sum += v; }
+                }
+            }
+        });
+    }
+    for (int p = 0; p < nb_producers; ++p) {
+        threads.emplace_back([&, p]() {
+            if (p == 0) {
+                for (int i = 1; i <= nb_items; ++i) { queue.push(i); }
+            } else {
+                std::vector<int> items(nb_items);
+                for (int i = 0; i < nb_items; ++i) { items[static_cast<std::size_t>(i)] = i + 1; }
+                queue.push_n(items.begin(), items.end());
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    BOOST_TEST(queue.empty());
+    BOOST_TEST(sum == nb_producers * (nb_items * (nb_items + 1L) / 2));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,132 @@
+#define BOOST_TEST_MODULE ChromeTracing
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <cstdlib>
+#include <new>
+#include <shared_mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "mutexed/chrome_tracing.hpp"
+
+using namespace llh::mutexed;
+
+
+// Makes the allocations of the calling thread fail while it is set.
+thread_local bool fail_allocations = false;
+
+void* operator new(std::size_t size) {
+    if (!fail_allocations) {
+        if (void* p = std::malloc(size == 0 ? 1 : size)) {
+            return p;
+        }
+    }
+    throw std::bad_alloc();
+}
+// Not inlined so that GCC does not pair the free() with the operator new of the callers.
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+
+BOOST_AUTO_TEST_SUITE(ChromeTracingTests)
+
+std::size_t count(std::string const& in, std::string const& what) {
+    std::size_t nb = 0;
+    for (auto pos = in.find(what); pos != std::string::npos; pos = in.find(what, pos + 1)) {
+        ++nb;
+    }
+    return nb;
+}
+
+BOOST_AUTO_TEST_CASE(WritesEventsOfAllThreads)
+{
+    using tracer = chrome_tracer<>;
+    Mutexed<int, traced_mutex<std::shared_mutex, tracer>, has_cv> traced(0);
+
+    std::thread other([&]() { traced.with_locked([](int& v) { ++v; }); });
+    other.join();
+    traced.wait([](int v) { return v == 1; });
+
+    std::ostringstream os;
+    tracer::write(os);
+    std::string const trace = os.str();
+
+    BOOST_TEST(trace.rfind("{\"traceEvents\":[", 0) == 0);
+    BOOST_TEST(count(trace, "\"tid\":1") > 0);
+    BOOST_TEST(count(trace, "\"tid\":2") > 0);
+    BOOST_TEST(count(trace, "\"name\":\"acquire\",\"cat\":\"mutexed\",\"ph\":\"B\"") == 2);
+    BOOST_TEST(count(trace, "\"name\":\"held\",\"cat\":\"mutexed\",\"ph\":\"b\"") == 2);
+    BOOST_TEST(count(trace, "\"name\":\"held\",\"cat\":\"mutexed\",\"ph\":\"e\"") == 2);
+    BOOST_TEST(count(trace, "\"name\":\"notify\"") == 1);
+    BOOST_TEST(count(trace, "\"name\":\"wait\"") == 2);
+    BOOST_TEST(count(trace, "\"mode\":\"shared\"") > 0);
+
+    // the events are drained by a write
+    std::ostringstream again;
+    tracer::write(again);
+    BOOST_TEST(count(again.str(), "\"name\"") == 0);
+}
+
+BOOST_AUTO_TEST_CASE(DropsEventsWhenFull)
+{
+    using tracer = chrome_tracer<4>;
+    Mutexed<int, traced_mutex<std::mutex, tracer>> traced(0);
+
+    // 3 events per access
+    traced.with_locked([](int& v) { ++v; });
+    traced.with_locked([](int& v) { ++v; });
+    BOOST_TEST(tracer::dropped() == 2);
+
+    std::ostringstream os;
+    tracer::write(os);
+    BOOST_TEST(count(os.str(), "\"name\":\"acquire\"") == 3);
+}
+
+BOOST_AUTO_TEST_CASE(DropsEventsOfUnregisteredThreads)
+{
+    using tracer = chrome_tracer<64>;
+    Mutexed<int, traced_mutex<std::mutex, tracer>> traced(0);
+
+    std::thread other([&]() {
+        // the buffer cannot be allocated, so the 3 events of the access are dropped
+        fail_allocations = true;
+        traced.with_locked([](int& v) { ++v; });
+        fail_allocations = false;
+        // the next event registers the buffer
+        traced.with_locked([](int& v) { ++v; });
+    });
+    other.join();
+
+    BOOST_TEST(traced.get_copy() == 2);
+    BOOST_TEST(tracer::dropped() == 3u);
+    std::ostringstream os;
+    tracer::write(os);
+    BOOST_TEST(count(os.str(), "\"name\":\"acquire\"") == 4);
+}
+
+BOOST_AUTO_TEST_CASE(RegistersThreadsEagerly)
+{
+    using tracer = chrome_tracer<64>;
+    bool threw = false;
+
+    std::thread other([&threw]() {
+        fail_allocations = true;
+        try {
+            tracer::register_thread();
+        } catch (std::bad_alloc const&) {
+            threw = true;
+        }
+        fail_allocations = false;
+        tracer::register_thread();
+    });
+    other.join();
+
+    BOOST_TEST(threw);
+    // registering records no event
+    std::ostringstream os;
+    tracer::write(os);
+    BOOST_TEST(count(os.str(), "\"name\"") == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
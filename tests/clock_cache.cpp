@@ -0,0 +1,191 @@
+#define BOOST_TEST_MODULE ClockCache
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "mutexed/clock_cache.hpp"
+
+using namespace llh::mutexed;
+
+
+BOOST_AUTO_TEST_SUITE(ClockCacheTests)
+
+BOOST_AUTO_TEST_CASE(Accesses)
+{
+    clock_cache<std::string, int> cache(100, 4);
+    BOOST_TEST(cache.nb_shards() == 4u);
+    BOOST_TEST(cache.capacity() == 100u);
+
+    BOOST_TEST(cache.insert_or_assign("a", 1));
+    BOOST_TEST(!cache.insert_or_assign("a", 2));
+    BOOST_TEST(cache.find_copy("a").value() == 2);
+    BOOST_TEST(!cache.find_copy("b"));
+    BOOST_TEST(cache.with_value_locked("a", [](int const& v) { return v * 10; }).value() == 20);
+    BOOST_TEST(cache.size() == 1u);
+
+    BOOST_TEST(cache.erase("a"));
+    BOOST_TEST(!cache.erase("a"));
+    BOOST_TEST(cache.size() == 0u);
+
+    cache.insert_or_assign("c", 3);
+    cache.clear();
+    BOOST_TEST(!cache.find_copy("c"));
+}
+
+BOOST_AUTO_TEST_CASE(ExplicitKeyConversion)
+{
+    clock_cache<std::string, int> cache(10, 2);
+    std::string_view const key = "a";
+
+    // a std::string_view only converts explicitly to the std::string that is hashed
+    BOOST_TEST(cache.insert_or_assign(key, 1));
+    BOOST_TEST(!cache.insert_or_assign(key, 2));
+    BOOST_TEST(cache.find_copy("a").value() == 2);
+    BOOST_TEST(cache.size() == 1u);
+}
+
+BOOST_AUTO_TEST_CASE(EvictsUnreferencedFirst)
+{
+    // a single shard makes the eviction order deterministic
+    clock_cache<int, int> cache(4, 1);
+    for (int k = 0; k < 4; ++k) {
+        cache.insert_or_assign(k, k);
+    }
+    BOOST_TEST(cache.size() == 4u);
+
+    // the hits give 0 and 2 a second chance
+    cache.find_copy(0);
+    cache.find_copy(2);
+    cache.insert_or_assign(4, 4);
+    cache.insert_or_assign(5, 5);
+
+    BOOST_TEST(cache.size() == 4u);
+    BOOST_TEST(cache.find_copy(0).has_value());
+    BOOST_TEST(!cache.find_copy(1).has_value());
+    BOOST_TEST(cache.find_copy(2).has_value());
+    BOOST_TEST(!cache.find_copy(3).has_value());
+    BOOST_TEST(cache.find_copy(4).has_value());
+    BOOST_TEST(cache.find_copy(5).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(ErasedSlotsAreReused)
+{
+    clock_cache<int, int> cache(3, 1);
+    for (int k = 0; k < 3; ++k) {
+        cache.insert_or_assign(k, k);
+    }
+    cache.erase(1);
+    cache.insert_or_assign(3, 3);
+
+    // nothing was evicted to make room for 3
+    for (int k : {0, 2, 3}) {
+        BOOST_TEST(cache.find_copy(k).has_value());
+    }
+}
+
+namespace {
+
+// A value whose copy throws when asked to.
+struct fragile {
+    int value = 0;
+    bool throws = false;
+
+    fragile(int v, bool t = false) : value(v), throws(t) {}
+    fragile(fragile const& other) : value(other.value), throws(false) {
+        if (other.throws) {
+            throw std::runtime_error("fragile");
+        }
+    }
+    fragile& operator=(fragile const&) = default;
+};
+
+// A hasher with a state, which a default-constructed one does not share.
+struct counting_hash {
+    std::atomic<int>* nb_calls = nullptr;
+
+    std::size_t operator()(int key) const {
+        if (nb_calls) {
+            ++*nb_calls;
+        }
+        return std::hash<int>{}(key);
+    }
+};
+
+} // end anonymous namespace
+
+BOOST_AUTO_TEST_CASE(ThrowingValue)
+{
+    clock_cache<int, fragile> cache(2, 1);
+
+    // in a free slot
+    BOOST_CHECK_THROW(cache.insert_or_assign(0, fragile(0, true)), std::runtime_error);
+    BOOST_TEST(cache.size() == 0u);
+    cache.insert_or_assign(1, fragile(1));
+    cache.insert_or_assign(2, fragile(2));
+    BOOST_TEST(cache.size() == 2u);
+
+    // in the slot of an evicted entry, which stays evicted
+    BOOST_CHECK_THROW(cache.insert_or_assign(3, fragile(3, true)), std::runtime_error);
+    BOOST_TEST(cache.size() == 1u);
+    BOOST_TEST(!cache.find_copy(3).has_value());
+
+    // all the slots are still usable
+    for (int k = 4; k < 8; ++k) {
+        cache.insert_or_assign(k, fragile(k));
+    }
+    BOOST_TEST(cache.size() == 2u);
+    BOOST_TEST(cache.find_copy(6).value().value == 6);
+    BOOST_TEST(cache.find_copy(7).value().value == 7);
+}
+
+BOOST_AUTO_TEST_CASE(StatefulHash)
+{
+    std::atomic<int> nb_calls = 0;
+    clock_cache<int, int, counting_hash> cache(64, 4, counting_hash{&nb_calls});
+
+    // selecting the shard uses the hasher given at construction
+    BOOST_TEST(!cache.find_copy(1).has_value());
+    BOOST_TEST(nb_calls > 0);
+
+    for (int i = 0; i < 32; ++i) {
+        cache.insert_or_assign(i, i);
+    }
+    // and so do the indexes of the shards, whose hash of each key is counted too
+    BOOST_TEST(nb_calls >= 64);
+    BOOST_TEST(cache.find_copy(10).value() == 10);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentHitsAndInserts)
+{
+    clock_cache<int, int> cache(256, 8);
+    constexpr int nb_keys = 1024;
+    std::atomic<int> nb_wrong = 0;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 5000; ++i) {
+                int const k = (i * 7 + t) % nb_keys;
+                if (auto v = cache.find_copy(k)) {
+                    nb_wrong += (*v != 2 * k);
+                } else {
+                    cache.insert_or_assign(k, 2 * k);
+                }
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+
+    BOOST_TEST(nb_wrong == 0);
+    BOOST_TEST(cache.size() <= cache.capacity());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,179 @@
+#define BOOST_TEST_MODULE ConcurrentMap
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "mutexed/concurrent_map.hpp"
+
+using namespace llh::mutexed;
+
+
+BOOST_AUTO_TEST_SUITE(ShardingTests)
+
+BOOST_AUTO_TEST_CASE(ShardIndex)
+{
+    std::vector<int> counts(8, 0);
+    for (std::size_t h = 0; h < 8000; ++h) {
+        std::size_t const i = details::shard_index(h, counts.size());
+        BOOST_REQUIRE(i < counts.size());
+        ++counts[i];
+    }
+    // consecutive hashes are spread over all the shards
+    for (int c : counts) {
+        BOOST_TEST(c > 500);
+    }
+    BOOST_TEST(details::shard_index(12345, 1) == 0u);
+    static_assert(alignof(details::cache_padded<char>) == details::cache_line_size);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+
+BOOST_AUTO_TEST_SUITE(ConcurrentMapTests)
+
+BOOST_AUTO_TEST_CASE(SingleKeyAccesses)
+{
+    concurrent_map<std::string, int> map(5);
+    BOOST_TEST(map.nb_shards() == 8u);
+
+    BOOST_TEST(map.insert_or_assign("a", 1));
+    BOOST_TEST(!map.insert_or_assign("a", 2));
+    BOOST_TEST(map.try_emplace("b", 3));
+    BOOST_TEST(!map.try_emplace("b", 4));
+    BOOST_TEST(map.size() == 2u);
+
+    BOOST_TEST(map.find_copy("a").value() == 2);
+    BOOST_TEST(!map.find_copy("c"));
+    BOOST_TEST(map.contains("b"));
+
+    BOOST_TEST(map.with_value_locked("a", [](int& v) { v *= 10; }));
+    BOOST_TEST(!map.with_value_locked("c", [](int& v) { v *= 10; }));
+    auto const& cmap = map;
+    BOOST_TEST(cmap.with_value_locked("a", [](int const& v) { return v + 1; }).value() == 21);
+
+    BOOST_TEST(map.erase("a"));
+    BOOST_TEST(!map.erase("a"));
+    BOOST_TEST(!map.contains("a"));
+
+    map.clear();
+    BOOST_TEST(map.size() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(ExplicitKeyConversion)
+{
+    concurrent_map<std::string, int> map(4);
+    std::string_view const key = "a";
+
+    // a std::string_view only converts explicitly to the std::string that is hashed
+    BOOST_TEST(map.insert_or_assign(key, 1));
+    BOOST_TEST(!map.insert_or_assign(key, 2));
+    BOOST_TEST(map.find_copy("a").value() == 2);
+    BOOST_TEST(map.size() == 1u);
+}
+
+namespace {
+
+// A hasher with a state, which a default-constructed one does not share.
+struct counting_hash {
+    std::atomic<int>* nb_calls = nullptr;
+
+    std::size_t operator()(int key) const {
+        if (nb_calls) {
+            ++*nb_calls;
+        }
+        return std::hash<int>{}(key);
+    }
+};
+
+} // end anonymous namespace
+
+BOOST_AUTO_TEST_CASE(StatefulHash)
+{
+    std::atomic<int> nb_calls = 0;
+    concurrent_map<int, int, counting_hash> map(4, counting_hash{&nb_calls});
+
+    // selecting the shard uses the hasher given at construction
+    BOOST_TEST(!map.contains(1));
+    BOOST_TEST(nb_calls > 0);
+
+    for (int i = 0; i < 100; ++i) {
+        map.insert_or_assign(i, i);
+    }
+    int const after_inserts = nb_calls;
+    // and so do the maps of the shards, whose hash of each key is counted too
+    BOOST_TEST(after_inserts >= 200);
+    BOOST_TEST(map.find_copy(42).value() == 42);
+    BOOST_TEST(map.size() == 100u);
+}
+
+BOOST_AUTO_TEST_CASE(ForEach)
+{
+    concurrent_map<int, int> map;
+    for (int i = 0; i < 100; ++i) {
+        map.insert_or_assign(i, i);
+    }
+
+    map.for_each([](int const&, int& v) { v *= 2; });
+
+    std::map<int, int> seen;
+    std::as_const(map).for_each([&seen](int const& k, int const& v) { seen.emplace(k, v); });
+    BOOST_TEST(seen.size() == 100u);
+    for (auto const& [k, v] : seen) {
+        BOOST_TEST(v == 2 * k);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ForEachIsConsistent)
+{
+    // moves a unit between two keys, which for_each must never see in flight
+    concurrent_map<int, int, std::hash<int>, std::equal_to<int>, std::mutex> map(64);
+    map.insert_or_assign(1, 100);
+    map.insert_or_assign(2, 0);
+    std::atomic<bool> done = false;
+
+    std::thread mover([&]() {
+        for (int i = 0; i < 2000; ++i) {
+            map.for_each([](int const& k, int& v) { v += (k == 1) ? -1 : 1; });
+        }
+        done = true;
+    });
+    while (!done) {
+        int total = 0;
+        std::as_const(map).for_each([&total](int const&, int const& v) { total += v; });
+        BOOST_TEST(total == 100);
+    }
+    mover.join();
+
+    BOOST_TEST(map.find_copy(2).value() == 2000);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentWriters)
+{
+    concurrent_map<int, int> map;
+    constexpr int nb_threads = 4;
+    constexpr int nb_keys = 1000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nb_threads; ++t) {
+        threads.emplace_back([&]() {
+            for (int k = 0; k < nb_keys; ++k) {
+                map.try_emplace(k, 0);
+                map.with_value_locked(k, [](int& v) { ++v; });
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    BOOST_TEST(map.size() == static_cast<std::size_t>(nb_keys));
+    std::as_const(map).for_each([=](int const&, int const& v) { BOOST_TEST(v == nb_threads); });
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,218 @@
+#define BOOST_TEST_MODULE DoubleBuffered
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mutexed/double_buffered.hpp"
+
+using namespace llh::mutexed;
+
+static_assert(double_bufferable<std::vector<int>>);
+static_assert(double_bufferable<std::string>);
+static_assert(!double_bufferable<int>);
+
+
+BOOST_AUTO_TEST_SUITE(DoubleBufferedTests)
+
+BOOST_AUTO_TEST_CASE(ProduceAndConsume)
+{
+    DoubleBufferedMutexed<std::vector<int>> buffers;
+    BOOST_TEST(buffers.empty());
+
+    buffers.push(1);
+    buffers.produce([](std::vector<int>& front) { front.insert(front.end(), {2, 3}); });
+    BOOST_TEST(!buffers.empty());
+
+    int const sum = buffers.consume([](std::vector<int>& batch) {
+        return std::accumulate(batch.begin(), batch.end(), 0);
+    });
+    BOOST_TEST(sum == 6);
+    BOOST_TEST(buffers.empty());
+
+    // an empty front buffer makes an empty batch
+    buffers.consume([](std::vector<int>& batch) { BOOST_TEST(batch.empty()); });
+}
+
+BOOST_AUTO_TEST_CASE(CapacityIsKept)
+{
+    DoubleBufferedMutexed<std::vector<int>> buffers;
+    int const* first_storage = nullptr;
+    int const* second_storage = nullptr;
+
+    for (int i = 0; i < 100; ++i) { buffers.push(i); }
+    buffers.consume([&](std::vector<int>& batch) { first_storage = batch.data(); });
+    for (int i = 0; i < 100; ++i) { buffers.push(i); }
+    buffers.consume([&](std::vector<int>& batch) { second_storage = batch.data(); });
+
+    // the buffers alternate, and neither reallocates once large enough
+    for (int round = 0; round < 4; ++round) {
+        for (int i = 0; i < 100; ++i) { buffers.push(i); }
+        buffers.consume([&](std::vector<int>& batch) {
+            BOOST_TEST(batch.size() == 100u);
+            BOOST_TEST(batch.data() == (round % 2 == 0 ? first_storage : second_storage));
+        });
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ConsumeWithoutBlockingProducers)
+{
+    DoubleBufferedMutexed<std::vector<int>> buffers;
+    buffers.push(1);
+
+    buffers.consume([&](std::vector<int>& batch) {
+        // a producer is not blocked while the batch is processed
+        std::thread producer([&]() { buffers.push(2); });
+        producer.join();
+        BOOST_TEST(batch == std::vector<int>{1});
+    });
+    buffers.consume([](std::vector<int>& batch) { BOOST_TEST(batch == std::vector<int>{2}); });
+}
+
+BOOST_AUTO_TEST_CASE(WaitAndConsumeFor)
+{
+    DoubleBufferedMutexed<std::vector<int>> buffers;
+
+    BOOST_TEST(!buffers.wait_and_consume_for(std::chrono::milliseconds(10), [](std::vector<int>&) {}));
+
+    std::thread producer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        buffers.push(42);
+    });
+    auto const size = buffers.wait_and_consume_for(std::chrono::seconds(10), [](std::vector<int>& batch) {
+        return batch.size();
+    });
+    producer.join();
+
+    BOOST_TEST(size.has_value());
+    BOOST_TEST(*size == 1u);
+}
+
+BOOST_AUTO_TEST_CASE(ProducersAndConsumers)
+{
+    DoubleBufferedMutexed<std::vector<int>> buffers;
+    constexpr int nb_producers = 4;
+    constexpr int nb_items = 1000;
+    std::atomic<int> nb_consumed = 0;
+    std::atomic<long> sum = 0;
+
+    auto consumer = [&]() {
+        while (nb_consumed < nb_producers * nb_items) {
+            buffers.wait_and_consume_for(std::chrono::milliseconds(5), [&](std::vector<int>& batch) {
+                sum += std::accumulate(batch.begin(), batch.end(), 0L);
+                nb_consumed += static_cast<int>(batch.size());
+            });
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.emplace_back(consumer);
+    threads.emplace_back(consumer);
+    for (int p = 0; p < nb_producers; ++p) {
+        threads.emplace_back([&]() {
+            for (int i = 1; i <= nb_items; ++i) {
+                buffers.push(i);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    BOOST_TEST(nb_consumed == nb_producers * nb_items);
+    BOOST_TEST(sum == nb_producers * (nb_items * (nb_items + 1L) / 2));
+}
+
+BOOST_AUTO_TEST_CASE(WaitingConsumersGetNoEmptyBatch)
+{
+    DoubleBufferedMutexed<std::vector<int>> buffers;
+    constexpr int nb_items = 20;
+    std::atomic<int> nb_consumed = 0;
+    std::atomic<int> nb_empty = 0;
+
+    auto consumer = [&]() {
+        while (nb_consumed < nb_items) {
+            buffers.wait_and_consume_for(std::chrono::milliseconds(5), [&](std::vector<int>& batch) {
+                nb_empty += batch.empty() ? 1 : 0;
+                nb_consumed += static_cast<int>(batch.size());
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            });
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int c = 0; c < 4; ++c) {
+        threads.emplace_back(consumer);
+    }
+    // the second element of a pair arrives while the first one is processed,
+    // and wakes up all the other consumers, which queue on the back buffer
+    for (int i = 0; i < nb_items; i += 2) {
+        buffers.push(i);
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        buffers.push(i + 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    BOOST_TEST(nb_consumed == nb_items);
+    BOOST_TEST(nb_empty == 0);
+}
+
+BOOST_AUTO_TEST_CASE(WaitingConsumersDoNotLockTheBackBuffer)
+{
+    DoubleBufferedMutexed<std::vector<int>> buffers;
+    std::atomic<int> nb_consumed = 0;
+
+    auto consumer = [&]() {
+        buffers.wait_and_consume([&](std::vector<int>& batch) { nb_consumed += static_cast<int>(batch.size()); });
+    };
+    std::thread first(consumer);
+    std::thread second(consumer);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    // both waiters wake up for the same element while the back buffer is
+    // locked, and one of them gets it while the other waits again
+    std::thread holder([&]() {
+        buffers.consume([](std::vector<int>&) { std::this_thread::sleep_for(std::chrono::milliseconds(40)); });
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    buffers.push(1);
+    holder.join();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    // the waiting consumer does not keep the back buffer locked
+    std::atomic<bool> consumed = false;
+    std::thread other([&]() {
+        buffers.consume([](std::vector<int>&) {});
+        consumed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    BOOST_TEST(consumed);
+
+    buffers.push(2);
+    first.join();
+    second.join();
+    other.join();
+    BOOST_TEST(nb_consumed == 2);
+}
+
+BOOST_AUTO_TEST_CASE(WaitAndConsume)
+{
+    DoubleBufferedMutexed<std::string> buffers;
+
+    std::thread producer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        buffers.produce([](std::string& front) { front += "abc"; });
+    });
+    std::string const got = buffers.wait_and_consume([](std::string& batch) { return batch; });
+    producer.join();
+
+    BOOST_TEST(got == "abc");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
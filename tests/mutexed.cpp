@@ -7,6 +7,15 @@
 #include <utility>
 #include <functional>
 #include <optional>
+#include <memory>
+#include <memory_resource>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #include <thread>
 #include <chrono>
@@ -87,6 +96,79 @@ BOOST_AUTO_TEST_CASE(Mutexed_GetCopy)
     BOOST_TEST(copy == 42);
 }
 
+BOOST_AUTO_TEST_CASE(Mutexed_CopyInto)
+{
+    Mutexed<std::vector<int>> const mutexed(std::vector<int>{1, 2, 3});
+
+    std::vector<int> out;
+    out.reserve(16);
+    int const* const storage = out.data();
+    mutexed.copy_into(out);
+    BOOST_TEST(out == std::vector<int>({1, 2, 3}));
+    // the capacity of the destination was reused
+    BOOST_TEST(out.data() == storage);
+
+    Mutexed<std::string> str("abc");
+    std::string out_str = "a longer string that has already allocated";
+    str.copy_into(out_str);
+    BOOST_TEST(out_str == "abc");
+    std::optional<std::string> out_opt;
+    str.copy_into(out_opt);
+    BOOST_TEST(out_opt.value() == "abc");
+}
+
+BOOST_AUTO_TEST_CASE(Mutexed_Allocators)
+{
+    std::pmr::monotonic_buffer_resource value_arena;
+    Mutexed<std::pmr::vector<int>> ints(std::allocator_arg, std::pmr::polymorphic_allocator<>(&value_arena), 3u, 7);
+    BOOST_TEST(ints.with_locked([](auto const& v) { return v.get_allocator().resource(); }) == &value_arena);
+    BOOST_TEST(ints.get_copy() == std::pmr::vector<int>({7, 7, 7}));
+
+    // the copy lands in the arena of the caller, not in the one of the value
+    std::pmr::monotonic_buffer_resource request_arena;
+    std::pmr::vector<int> copy = ints.get_copy(std::pmr::polymorphic_allocator<>(&request_arena));
+    BOOST_TEST(copy == std::pmr::vector<int>({7, 7, 7}));
+    BOOST_TEST(copy.get_allocator().resource() == &request_arena);
+
+    // the allocator propagates to the elements of nested containers
+    Mutexed<std::pmr::vector<std::pmr::string>> strs(std::allocator_arg, std::pmr::polymorphic_allocator<>(&value_arena));
+    strs.with_locked([](std::pmr::vector<std::pmr::string>& v) {
+        v.emplace_back("a string too long for the small string optimization");
+    });
+    auto const strs_copy = strs.get_copy(std::pmr::polymorphic_allocator<>(&request_arena));
+    BOOST_TEST(strs_copy.front().get_allocator().resource() == &request_arena);
+
+    // types that do not use allocators cannot be given one
+    static_assert(!std::is_constructible_v<Mutexed<int>, std::allocator_arg_t, std::allocator<int>>);
+}
+
+BOOST_AUTO_TEST_CASE(Mutexed_MovingOut)
+{
+    Mutexed<std::vector<int>> m(std::vector<int>{1, 2});
+
+    std::vector<int> old = m.exchange(std::vector<int>{3});
+    BOOST_TEST(old == std::vector<int>({1, 2}));
+
+    std::vector<int> other{4, 5};
+    m.swap(other);
+    BOOST_TEST(other == std::vector<int>({3}));
+
+    BOOST_TEST(m.take() == std::vector<int>({4, 5}));
+    BOOST_TEST(m.get_copy().empty());
+
+    // the drained value keeps nothing of the spare, which lends its capacity
+    m.with_locked([](std::vector<int>& v) { v.assign({6, 7}); });
+    std::vector<int> spare{8};
+    spare.reserve(64);
+    int const* const spare_storage = spare.data();
+    m.drain_into(spare);
+    BOOST_TEST(spare == std::vector<int>({6, 7}));
+    auto [lock, v] = m.locked();
+    BOOST_TEST(v.empty());
+    BOOST_TEST(v.capacity() >= 64u);
+    BOOST_TEST(v.data() == spare_storage);
+}
+
 BOOST_AUTO_TEST_CASE(Mutexed_WithLocked_Const)
 {
     Mutexed<int> const mutexed(42);
@@ -204,6 +286,441 @@ BOOST_AUTO_TEST_CASE(WithAllLocked)
     BOOST_TEST(stats.has_been_unique_locked() == true);
 }
 
+BOOST_AUTO_TEST_CASE(WithAllLocked_Ordered)
+{
+    lock_stats stats_a;
+    lock_stats stats_b;
+    Mutexed<int, lockable_spy<std::shared_mutex>> a(42, stats_a);
+    Mutexed<int, lockable_spy<std::mutex>> b(8, stats_b);
+
+    int from_a = with_all_locked(ordered_locking, [](int const& in_a, int& in_b) {
+            in_b = 10;
+            return in_a;
+        },
+        std::cref(a), b
+    );
+    BOOST_TEST(from_a == 42);
+    BOOST_TEST(b.get_copy() == 10);
+
+    // each mutex is locked exactly once, without any attempt
+    BOOST_TEST(stats_a.nb_locked_shared == 1);
+    BOOST_TEST(stats_a.nb_unlocked_shared == 1);
+    BOOST_TEST(stats_a.has_been_unique_locked() == false);
+    BOOST_TEST(stats_b.nb_locked == 2);
+    BOOST_TEST(stats_b.nb_try_locked == 0);
+}
+
+BOOST_AUTO_TEST_CASE(WithAllLocked_Ranges)
+{
+    lock_stats stats;
+    std::deque<Mutexed<int, lockable_spy<std::shared_mutex>>> accounts;
+    for (int i = 0; i < 20; ++i) {
+        accounts.emplace_back(i, stats);
+    }
+    std::vector<std::reference_wrapper<Mutexed<int, lockable_spy<std::shared_mutex>> const>> read_only{
+        std::cref(accounts[0]), std::cref(accounts[1])
+    };
+    std::array<std::reference_wrapper<Mutexed<int, lockable_spy<std::shared_mutex>>>, 2> written{
+        std::ref(accounts[1]), std::ref(accounts[2])
+    };
+
+    int sum = with_all_locked([](std::span<std::reference_wrapper<int const>> in, std::span<std::reference_wrapper<int>> out) {
+            int read = in[0] + in[1];
+            out[0].get() = 10;
+            out[1].get() = 20;
+            return read;
+        },
+        read_only, written
+    );
+    BOOST_TEST(sum == 1);
+
+    // accounts[1] is locked once, exclusively
+    BOOST_TEST(stats.nb_locked_shared == 1);
+    BOOST_TEST(stats.nb_locked == 2);
+    BOOST_TEST(stats.nb_unlocked == 2);
+    BOOST_TEST(stats.nb_unlocked_shared == 1);
+    BOOST_TEST(stats.nb_try_locked == 0);
+
+    // more Mutexed than the inline capacity, shared through std::cref
+    stats = lock_stats();
+    int total = with_all_locked([](std::span<std::reference_wrapper<int const>> all) {
+            int t = 0;
+            for (int v : all) t += v;
+            return t;
+        },
+        std::cref(accounts)
+    );
+    BOOST_TEST(total == 190 - 1 - 2 + 10 + 20);
+    BOOST_TEST(stats.nb_locked_shared == 20);
+    BOOST_TEST(stats.has_been_unique_locked() == false);
+}
+
+BOOST_AUTO_TEST_CASE(WithAllLocked_Ranges_ConstAndMutable)
+{
+    // with a std::mutex, the const and the mutable accesses both lock exclusively,
+    // but only the mutable one invalidates the snapshot and notifies
+    using mutexed = Mutexed<int, std::mutex, has_cv, has_snapshot>;
+    mutexed m(1);
+    BOOST_TEST(*m.get_snapshot() == 1);
+
+    // not notified, the waiter would only see the value once its wait times out
+    std::chrono::steady_clock::duration waited{};
+    std::thread waiter([&]() {
+        auto const start = std::chrono::steady_clock::now();
+        m.wait_for(std::chrono::seconds(10), [](int v) { return v == 42; });
+        waited = std::chrono::steady_clock::now() - start;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    std::array<std::reference_wrapper<mutexed const>, 1> read{std::cref(m)};
+    std::array<std::reference_wrapper<mutexed>, 1> written{std::ref(m)};
+    with_all_locked([](std::span<std::reference_wrapper<int const>> in, std::span<std::reference_wrapper<int>> out) {
+            out[0].get() = in[0] + 41;
+        },
+        read, written
+    );
+    waiter.join();
+
+    BOOST_TEST((waited < std::chrono::seconds(5)));
+    BOOST_TEST(m.get_copy() == 42);
+    BOOST_TEST(*m.get_snapshot() == 42);
+}
+
+
+BOOST_AUTO_TEST_CASE(LockedAll)
+{
+    lock_stats stats_a;
+    lock_stats stats_b;
+    Mutexed<int, lockable_spy<std::shared_mutex>> a(42, stats_a);
+    Mutexed<int, lockable_spy<std::shared_mutex>> b(8, stats_b);
+    Mutexed<int> c(1);
+
+    {
+        auto [lock, in_a, in_b, in_c] = locked_all(a, std::cref(b), c);
+        static_assert(std::is_same_v<decltype(in_b), int const&>);
+        in_a += in_b;
+        in_c = in_b;
+
+        BOOST_TEST(stats_a.nb_unlocked == 0);
+        BOOST_TEST(stats_b.nb_unlocked_shared == 0);
+    }
+    BOOST_TEST(stats_a.has_been_unique_locked() == true);
+    BOOST_TEST(stats_a.has_been_shared_locked() == false);
+    BOOST_TEST(stats_b.has_been_shared_locked() == true);
+    BOOST_TEST(stats_b.has_been_unique_locked() == false);
+    BOOST_TEST(stats_a.nb_unlocked == 1);
+    BOOST_TEST(stats_b.nb_unlocked_shared == 1);
+    BOOST_TEST(a.get_copy() == 50);
+    BOOST_TEST(c.get_copy() == 8);
+
+    stats_a = lock_stats();
+    stats_b = lock_stats();
+    {
+        auto [lock, in_a, in_b] = locked_all(ordered_locking, a, b);
+        std::swap(in_a, in_b);
+    }
+    BOOST_TEST(stats_a.nb_locked == 1);
+    BOOST_TEST(stats_b.nb_locked == 1);
+    BOOST_TEST(stats_a.nb_try_locked == 0);
+    BOOST_TEST(a.get_copy() == 8);
+}
+
+// Runs f in another thread, since trying to lock a mutex already owned by the caller is undefined.
+template<typename F>
+void from_other_thread(F&& f) {
+    std::thread t(std::forward<F>(f));
+    t.join();
+}
+
+BOOST_AUTO_TEST_CASE(TryWithLocked)
+{
+    Mutexed<int, std::shared_timed_mutex> m(1);
+    using namespace std::chrono_literals;
+
+    std::optional<int> read = m.try_with_locked([](int const& v) { return v; });
+    BOOST_TEST((read == 1));
+    BOOST_TEST(m.try_with_locked([](int& v) { ++v; }) == true);
+    BOOST_TEST(m.with_locked_for(1ms, [](int& v) { return ++v; }).value() == 3);
+    BOOST_TEST(std::cref(m).get().with_locked_until(std::chrono::steady_clock::now() + 1ms, [](int v) { return v; }).value() == 3);
+
+    {
+        auto [lock, v] = m.locked();
+        from_other_thread([&m]() {
+            BOOST_TEST(m.try_with_locked([](int& v) { ++v; }) == false);
+            BOOST_TEST(!std::cref(m).get().try_with_locked([](int v) { return v; }).has_value());
+            BOOST_TEST(!m.with_locked_for(5ms, [](int& v) { return v; }).has_value());
+            BOOST_TEST(!std::cref(m).get().with_locked_until(std::chrono::steady_clock::now() + 5ms, [](int v) { return v; }));
+        });
+    }
+
+    {
+        // readers are not excluded by a shared lock
+        auto const [lock, v] = m.locked_const();
+        from_other_thread([&m]() {
+            BOOST_TEST(std::cref(m).get().try_with_locked([](int v) { return v; }).value() == 3);
+            BOOST_TEST(m.try_with_locked([](int& v) { ++v; }) == false);
+        });
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TryLocked)
+{
+    Mutexed<int, std::timed_mutex> m(1);
+    using namespace std::chrono_literals;
+
+    {
+        auto [lock, v] = m.try_locked();
+        BOOST_TEST(static_cast<bool>(lock));
+        BOOST_REQUIRE(v != nullptr);
+        *v = 2;
+
+        from_other_thread([&m]() {
+            auto [other_lock, other_v] = m.try_locked_for(5ms);
+            BOOST_TEST(!other_lock);
+            BOOST_TEST(other_v == nullptr);
+            auto const [const_lock, const_v] = std::cref(m).get().try_locked();
+            BOOST_TEST(!const_lock.owns_lock());
+            BOOST_TEST(const_v == nullptr);
+        });
+    }
+
+    auto [lock, v] = std::cref(m).get().try_locked_until(std::chrono::steady_clock::now() + 5ms);
+    BOOST_TEST(lock.owns_lock());
+    BOOST_TEST(*v == 2);
+}
+
+BOOST_AUTO_TEST_CASE(TryWithAllLocked)
+{
+    lock_stats stats;
+    Mutexed<int, lockable_spy<std::shared_mutex>> a(42, stats);
+    Mutexed<int> b(8);
+
+    std::optional<int> from_a = try_with_all_locked([](int const& in_a, int& in_b) {
+        in_b = 10;
+        return in_a;
+    }, std::cref(a), b);
+    BOOST_TEST((from_a == 42));
+    BOOST_TEST(b.get_copy() == 10);
+    BOOST_TEST(stats.has_been_shared_locked() == true);
+    BOOST_TEST(stats.has_been_unique_locked() == false);
+
+    {
+        auto [lock, in_b] = b.locked();
+        from_other_thread([&]() {
+            BOOST_TEST(try_with_all_locked([](int&, int&) {}, a, b) == false);
+            BOOST_TEST(try_with_all_locked([](int&) {}, b) == false);
+        });
+    }
+    // a was released when b could not be locked
+    BOOST_TEST(stats.nb_try_locked == stats.nb_unlocked);
+    BOOST_TEST(try_with_all_locked([](int& in_a) { in_a = 0; }, a) == true);
+}
+
+struct trace_counts {
+    int acquire_begin = 0;
+    int acquire_end = 0;
+    int release = 0;
+    int notify = 0;
+    int wait_begin = 0;
+    int wait_end = 0;
+    lock_mode last_mode = lock_mode::exclusive;
+};
+
+struct counting_tracer : tracing_policy {
+    static inline trace_counts counts;
+
+    static void acquire_begin(void const*, lock_mode mode) noexcept {
+        ++counts.acquire_begin;
+        counts.last_mode = mode;
+    }
+    static void acquire_end(void const*, lock_mode) noexcept { ++counts.acquire_end; }
+    static void release(void const*, lock_mode) noexcept { ++counts.release; }
+    static void notify(void const*) noexcept { ++counts.notify; }
+    static void wait_begin(void const*, lock_mode) noexcept { ++counts.wait_begin; }
+    static void wait_end(void const*, lock_mode) noexcept { ++counts.wait_end; }
+};
+
+static_assert(shared_lockable<traced_mutex<std::shared_mutex, counting_tracer>>);
+static_assert(!shared_lockable<traced_mutex<std::mutex, counting_tracer>>);
+
+BOOST_AUTO_TEST_CASE(TracedMutex)
+{
+    using traced = traced_mutex<std::shared_mutex, counting_tracer>;
+    Mutexed<int, traced, has_cv> a(1);
+    Mutexed<int, traced> b(2);
+
+    counting_tracer::counts = trace_counts();
+    a.with_locked([](int& v) { ++v; });
+    BOOST_TEST(counting_tracer::counts.acquire_begin == 1);
+    BOOST_TEST(counting_tracer::counts.acquire_end == 1);
+    BOOST_TEST(counting_tracer::counts.release == 1);
+    BOOST_TEST(counting_tracer::counts.notify == 1);
+    BOOST_TEST((counting_tracer::counts.last_mode == lock_mode::exclusive));
+
+    counting_tracer::counts = trace_counts();
+    BOOST_TEST(a.get_copy() == 2);
+    BOOST_TEST((counting_tracer::counts.last_mode == lock_mode::shared));
+    BOOST_TEST(counting_tracer::counts.release == 1);
+    BOOST_TEST(counting_tracer::counts.notify == 0);
+
+    counting_tracer::counts = trace_counts();
+    a.wait([](int v) { return v == 2; });
+    BOOST_TEST(counting_tracer::counts.wait_begin == 1);
+    BOOST_TEST(counting_tracer::counts.wait_end == 1);
+
+    counting_tracer::counts = trace_counts();
+    with_all_locked([](int& in_a, int const& in_b) { in_a += in_b; }, a, std::cref(b));
+    BOOST_TEST(counting_tracer::counts.acquire_end == 2);
+    BOOST_TEST(counting_tracer::counts.release == 2);
+    BOOST_TEST(counting_tracer::counts.notify == 1);
+
+    // a shared-locked Mutexed is not notified
+    counting_tracer::counts = trace_counts();
+    with_all_locked([](int const&, int&) {}, std::cref(a), b);
+    BOOST_TEST(counting_tracer::counts.notify == 0);
+
+    counting_tracer::counts = trace_counts();
+    std::array<std::reference_wrapper<Mutexed<int, traced, has_cv>>, 2> twice{a, a};
+    with_all_locked([](std::span<std::reference_wrapper<int>>) {}, twice);
+    BOOST_TEST(counting_tracer::counts.release == 1);
+    BOOST_TEST(counting_tracer::counts.notify == 1);
+
+    counting_tracer::counts = trace_counts();
+    {
+        auto [lock, in_a, in_b] = locked_all(a, std::cref(b));
+        in_a += in_b;
+        BOOST_TEST(counting_tracer::counts.notify == 0);
+    }
+    BOOST_TEST(counting_tracer::counts.release == 2);
+    // only a, which has_cv and was write-accessed, is notified
+    BOOST_TEST(counting_tracer::counts.notify == 1);
+}
+
+BOOST_AUTO_TEST_CASE(WithLockedIf)
+{
+    lock_stats stats;
+    Mutexed<int, lockable_spy<std::shared_mutex>> spied(1, stats);
+    auto is_odd = [](int v) { return v % 2 == 1; };
+
+    BOOST_TEST(spied.with_locked_if(is_odd, [](int& v) { return ++v; }).value() == 2);
+    BOOST_TEST(stats.nb_locked_shared == 1);
+    BOOST_TEST(stats.nb_locked == 1);
+
+    // a no-op does not take the exclusive lock
+    stats = lock_stats();
+    BOOST_TEST(spied.with_locked_if(is_odd, [](int& v) { ++v; }) == false);
+    BOOST_TEST(stats.nb_locked_shared == 1);
+    BOOST_TEST(stats.has_been_unique_locked() == false);
+
+    using traced = traced_mutex<std::mutex, counting_tracer>;
+    Mutexed<int, traced, has_cv> notifying(1);
+
+    counting_tracer::counts = trace_counts();
+    BOOST_TEST(notifying.with_locked_if(is_odd, [](int& v) { ++v; }) == true);
+    BOOST_TEST(counting_tracer::counts.acquire_end == 1);
+    BOOST_TEST(counting_tracer::counts.notify == 1);
+
+    counting_tracer::counts = trace_counts();
+    BOOST_TEST(notifying.with_locked_if(is_odd, [](int& v) { ++v; }) == false);
+    BOOST_TEST(counting_tracer::counts.release == 1);
+    BOOST_TEST(counting_tracer::counts.notify == 0);
+    BOOST_TEST(notifying.get_copy() == 2);
+}
+
+// A value whose comparison always throws.
+struct throwing_equal {
+    int val = 0;
+
+    bool operator==(throwing_equal const&) const { throw std::runtime_error("cannot compare"); }
+};
+
+BOOST_AUTO_TEST_CASE(ChangeAwareNotifications)
+{
+    using traced = traced_mutex<std::mutex, counting_tracer>;
+    Mutexed<int, traced, has_cv> m(1);
+
+    counting_tracer::counts = trace_counts();
+    BOOST_TEST(m.with_locked(report_change, [](int& v) { return v == 0 ? (v = 1, true) : false; }) == false);
+    BOOST_TEST(counting_tracer::counts.release == 1);
+    BOOST_TEST(counting_tracer::counts.notify == 0);
+    BOOST_TEST(m.with_locked(report_change, [](int& v) { return ++v, true; }) == true);
+    BOOST_TEST(counting_tracer::counts.notify == 1);
+
+    counting_tracer::counts = trace_counts();
+    BOOST_TEST(m.with_locked(detect_change, [](int& v) { v = 2; return v; }) == 2);
+    BOOST_TEST(counting_tracer::counts.notify == 0);
+    m.with_locked(detect_change, [](int& v) { v = 3; });
+    BOOST_TEST(counting_tracer::counts.notify == 1);
+
+    counting_tracer::counts = trace_counts();
+    BOOST_CHECK_THROW(m.with_locked(detect_change, [](int&) { throw 0; }), int);
+    BOOST_TEST(counting_tracer::counts.notify == 1);
+
+    // the result keeps its type, even when it refers to the wrapped value
+    int& ref = m.with_locked(detect_change, [](int& v) -> int& { return v; });
+    BOOST_TEST(&ref == &m.with_locked([](int& v) -> int& { return v; }));
+
+    // a comparison that throws propagates, and the waiters are notified
+    Mutexed<throwing_equal, traced, has_cv> throwing;
+    counting_tracer::counts = trace_counts();
+    BOOST_CHECK_THROW(throwing.with_locked(detect_change, [](throwing_equal& t) { ++t.val; }), std::runtime_error);
+    BOOST_TEST(counting_tracer::counts.release == 1);
+    BOOST_TEST(counting_tracer::counts.notify == 1);
+    BOOST_TEST(throwing.with_locked([](throwing_equal const& t) { return t.val; }) == 1);
+
+    counting_tracer::counts = trace_counts();
+    {
+        auto [lock, v] = m.locked();
+        BOOST_TEST(v == 3);
+        lock.mark_unchanged();
+    }
+    BOOST_TEST(counting_tracer::counts.release == 1);
+    BOOST_TEST(counting_tracer::counts.notify == 0);
+
+    // without a condition-variable, detect_change makes no copy
+    Mutexed<int> plain(0);
+    BOOST_TEST(plain.with_locked(detect_change, [](int& v) { return ++v; }) == 1);
+}
+
+BOOST_AUTO_TEST_CASE(GetSnapshot)
+{
+    lock_stats stats;
+    Mutexed<std::vector<int>, lockable_spy<std::shared_mutex>, no_cv, has_snapshot> m(std::vector<int>{1, 2, 3}, stats);
+
+    std::shared_ptr<std::vector<int> const> first = m.get_snapshot();
+    BOOST_TEST(first->size() == 3u);
+    BOOST_TEST(stats.nb_locked_shared == 1);
+
+    // the reads between two writes share the same copy without locking
+    BOOST_TEST(m.get_snapshot() == first);
+    BOOST_TEST(stats.nb_locked_shared == 1);
+
+    // a read-only access keeps it
+    BOOST_TEST(m.get_copy().size() == 3u);
+    BOOST_TEST(m.get_snapshot() == first);
+
+    // every mutable access drops it
+    m.with_locked([](std::vector<int>& v) { v.push_back(4); });
+    auto second = m.get_snapshot();
+    BOOST_TEST(second != first);
+    BOOST_TEST(second->size() == 4u);
+    BOOST_TEST(first->size() == 3u);
+
+    {
+        auto [lock, v] = m.locked();
+        v.clear();
+    }
+    BOOST_TEST(m.get_snapshot()->empty());
+
+    Mutexed<int, std::shared_mutex, no_cv, has_snapshot> a(1);
+    Mutexed<int> b(2);
+    auto before = a.get_snapshot();
+    with_all_locked([](int const&, int const&) {}, std::cref(a), std::cref(b));
+    BOOST_TEST(a.get_snapshot() == before);
+    with_all_locked([](int& in_a, int const& in_b) { in_a += in_b; }, a, std::cref(b));
+    BOOST_TEST(*a.get_snapshot() == 3);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
@@ -242,6 +759,74 @@ BOOST_AUTO_TEST_CASE(ConcurrentAccess)
     BOOST_TEST(mutexed.get_copy() == expectedValue);
 }
 
+BOOST_AUTO_TEST_CASE(WithAllLocked_OppositeOrders)
+{
+    const int iterations = 1000;
+
+    Mutexed<int> a(0);
+    Mutexed<int> b(0);
+
+    auto transfer = [](int& from, int& to) {
+        --from;
+        ++to;
+    };
+
+    // every thread passes the Mutexed in a different order, with both strategies
+    std::thread ordered_ab([&]() {
+        for (int i = 0; i < iterations; ++i) with_all_locked(ordered_locking, transfer, a, b);
+    });
+    std::thread ordered_ba([&]() {
+        for (int i = 0; i < iterations; ++i) with_all_locked(ordered_locking, transfer, b, a);
+    });
+    std::thread backoff_ab([&]() {
+        for (int i = 0; i < iterations; ++i) with_all_locked(backoff_locking, transfer, a, b);
+    });
+    ordered_ab.join();
+    ordered_ba.join();
+    backoff_ab.join();
+
+    BOOST_TEST(a.get_copy() == -iterations);
+    BOOST_TEST(b.get_copy() == iterations);
+}
+
+BOOST_AUTO_TEST_CASE(WithAllLocked_Ranges_Transfers)
+{
+    const int numThreads = 8;
+    const int iterations = 500;
+    const int nbAccounts = 5;
+
+    std::vector<Mutexed<int>> accounts(nbAccounts);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&accounts, t]() {
+            for (int i = 0; i < iterations; ++i) {
+                // every thread touches the accounts in a different order
+                std::array<std::reference_wrapper<Mutexed<int>>, 3> touched{
+                    std::ref(accounts[(t + i) % nbAccounts]),
+                    std::ref(accounts[(t + 2 * i + 1) % nbAccounts]),
+                    std::ref(accounts[(3 * t + i + 2) % nbAccounts])
+                };
+                with_all_locked([](std::span<std::reference_wrapper<int>> values) {
+                    values[0].get() -= 2;
+                    values[1].get() += 1;
+                    values[2].get() += 1;
+                }, touched);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    int total = with_all_locked([](std::span<std::reference_wrapper<int const>> values) {
+        int t = 0;
+        for (int v : values) t += v;
+        return t;
+    }, std::cref(accounts));
+    BOOST_TEST(total == 0);
+}
+
 struct flagged_int {
     int val = 1;
     bool initialized = false;
@@ -293,6 +878,81 @@ BOOST_AUTO_TEST_CASE(stdSharedMutex_CV_sync)
     test_sync<std::shared_mutex>();
 }
 
+BOOST_AUTO_TEST_CASE(stdMutex_CV_sync_from_with_all_locked)
+{
+    Mutexed<flagged_int, std::mutex, has_cv> init_after;
+    Mutexed<int> source(2);
+
+    std::thread to_do_after([&](){
+        init_after.wait([](flagged_int const& fi){ return fi.initialized; });
+    });
+    // making sure it stopped at the point where it waits
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    // change and notify
+    with_all_locked([](flagged_int& fi, int const& v) { fi.set(v); }, init_after, std::cref(source));
+
+    to_do_after.join();
+
+    BOOST_TEST(init_after.get_copy().val == 2);
+}
+
+BOOST_AUTO_TEST_CASE(WaitAny)
+{
+    Mutexed<std::deque<int>, std::mutex, has_cv> jobs;
+    Mutexed<bool, std::shared_mutex, has_cv> shutdown(false);
+    auto has_job = [](std::deque<int> const& q) { return !q.empty(); };
+    auto stopped = [](bool stop) { return stop; };
+
+    // a predicate that is already true returns without waiting
+    jobs.with_locked([](std::deque<int>& q) { q.push_back(1); });
+    BOOST_TEST(wait_any(has_job, jobs, stopped, shutdown) == 0u);
+    jobs.with_locked([](std::deque<int>& q) { q.clear(); });
+
+    std::atomic<std::size_t> woken_by = 42;
+    std::thread consumer([&](){
+        woken_by = wait_any(has_job, jobs, stopped, shutdown);
+    });
+    // making sure it stopped at the point where it waits
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    // a write-access that keeps the predicates false does not wake it up for good
+    jobs.with_locked([](std::deque<int>&) {});
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    BOOST_TEST(woken_by == 42u);
+
+    shutdown.with_locked([](bool& stop) { stop = true; });
+    consumer.join();
+
+    BOOST_TEST(woken_by == 1u);
+}
+
+BOOST_AUTO_TEST_CASE(WaitAll)
+{
+    Mutexed<flagged_int, std::mutex, has_cv> a;
+    Mutexed<flagged_int, std::shared_mutex, has_cv> b;
+    auto initialized = [](flagged_int const& fi) { return fi.initialized; };
+
+    std::atomic<bool> waiting_is_over = false;
+    std::thread waiter([&](){
+        wait_all(initialized, a, initialized, b);
+        waiting_is_over = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    a.with_locked([](flagged_int& fi) { fi.set(1); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    BOOST_TEST(!waiting_is_over);
+
+    {
+        auto [lock, fi] = b.locked();
+        fi.set(2);
+    }
+    waiter.join();
+
+    BOOST_TEST(waiting_is_over);
+}
+
 BOOST_AUTO_TEST_CASE(stdMutex_CV_sync_from_locked)
 {
     Mutexed<flagged_int, std::mutex, has_cv> init_after;
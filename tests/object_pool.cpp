@@ -0,0 +1,130 @@
+#define BOOST_TEST_MODULE ObjectPool
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "mutexed/object_pool.hpp"
+
+using namespace llh::mutexed;
+
+namespace {
+
+//! Counts its live instances.
+struct tracked {
+    static inline std::atomic<int> nb_alive = 0;
+    int value = 0;
+
+    tracked() { ++nb_alive; }
+    explicit tracked(int v) : value(v) { ++nb_alive; }
+    ~tracked() { --nb_alive; }
+};
+
+} // end anonymous namespace
+
+
+BOOST_AUTO_TEST_SUITE(ObjectPoolTests)
+
+BOOST_AUTO_TEST_CASE(ReusesObjects)
+{
+    object_pool<tracked, 4> pool(1);
+    BOOST_TEST(pool.size() == 0u);
+
+    auto a = pool.acquire();
+    tracked* const address = a.get();
+    pool.release(std::move(a));
+    BOOST_TEST(pool.size() == 1u);
+
+    auto b = pool.acquire([] { return std::make_unique<tracked>(42); });
+    BOOST_TEST(b.get() == address);
+    BOOST_TEST(b->value == 0);
+    auto c = pool.acquire([] { return std::make_unique<tracked>(42); });
+    BOOST_TEST(c->value == 42);
+
+    pool.release(nullptr);
+    BOOST_TEST(pool.size() == 0u);
+    BOOST_TEST(tracked::nb_alive == 2);
+}
+
+BOOST_AUTO_TEST_CASE(ExchangesBatchesWithTheDepot)
+{
+    tracked::nb_alive = 0;
+    {
+        object_pool<tracked, 4> pool(2);
+        std::vector<std::unique_ptr<tracked>> held;
+        for (int i = 0; i < 20; ++i) {
+            held.push_back(pool.acquire());
+        }
+        std::set<tracked*> const addresses = [&held] {
+            std::set<tracked*> s;
+            for (auto& p : held) { s.insert(p.get()); }
+            return s;
+        }();
+
+        // released by one thread, beyond what its cache holds
+        for (auto& p : held) {
+            pool.release(std::move(p));
+        }
+        BOOST_TEST(pool.size() == 20u);
+
+        // acquired by another one, through the depot
+        std::size_t nb_reused = 0;
+        std::thread other([&]() {
+            std::vector<std::unique_ptr<tracked>> reacquired;
+            for (int i = 0; i < 20; ++i) {
+                reacquired.push_back(pool.acquire());
+            }
+            for (auto& p : reacquired) {
+                nb_reused += addresses.count(p.get());
+            }
+            for (auto& p : reacquired) {
+                pool.release(std::move(p));
+            }
+        });
+        other.join();
+        // the objects left in the cache of the first thread are not reachable from the other one
+        BOOST_TEST(nb_reused >= 12u);
+        BOOST_TEST(tracked::nb_alive >= 20);
+
+        pool.clear();
+        BOOST_TEST(pool.size() == 0u);
+        BOOST_TEST(tracked::nb_alive == 0);
+    }
+    BOOST_TEST(tracked::nb_alive == 0);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentAcquisitions)
+{
+    tracked::nb_alive = 0;
+    object_pool<tracked> pool;
+    constexpr int nb_threads = 4;
+    constexpr int nb_iterations = 5000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nb_threads; ++t) {
+        threads.emplace_back([&]() {
+            std::vector<std::unique_ptr<tracked>> held;
+            for (int i = 0; i < nb_iterations; ++i) {
+                held.push_back(pool.acquire());
+                if (held.size() == 100) {
+                    for (auto& p : held) {
+                        pool.release(std::move(p));
+                    }
+                    held.clear();
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    // every thread held at most 100 objects at a time
+    BOOST_TEST(tracked::nb_alive <= nb_threads * 100 + static_cast<int>(pool.nb_stripes() * 2 * decltype(pool)::batch_size));
+    BOOST_TEST(pool.size() == static_cast<std::size_t>(tracked::nb_alive.load()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
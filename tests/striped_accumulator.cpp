@@ -0,0 +1,142 @@
+#define BOOST_TEST_MODULE StripedAccumulator
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "mutexed/striped_accumulator.hpp"
+
+using namespace llh::mutexed;
+
+namespace {
+
+struct stats {
+    std::int64_t nb = 0;
+    std::int64_t total = 0;
+    std::int64_t max = std::numeric_limits<std::int64_t>::min();
+};
+
+struct merge_stats {
+    stats operator()(stats a, stats const& b) const {
+        return stats{a.nb + b.nb, a.total + b.total, std::max(a.max, b.max)};
+    }
+};
+
+// A value with no default constructor, which the stripes are copied from the identity into.
+struct histogram {
+    std::vector<int> buckets;
+
+    explicit histogram(std::size_t nb_buckets) : buckets(nb_buckets, 0) {}
+};
+
+struct merge_histograms {
+    histogram operator()(histogram a, histogram const& b) const {
+        for (std::size_t i = 0; i < a.buckets.size(); ++i) {
+            a.buckets[i] += b.buckets[i];
+        }
+        return a;
+    }
+};
+
+} // end anonymous namespace
+
+
+BOOST_AUTO_TEST_SUITE(StripedAccumulatorTests)
+
+BOOST_AUTO_TEST_CASE(Counter)
+{
+    striped_accumulator<std::int64_t> counter(0, {}, 3);
+    BOOST_TEST(counter.nb_stripes() == 4u);
+    BOOST_TEST(counter.get_copy() == 0);
+
+    counter.with_locked([](std::int64_t& v) { ++v; });
+    counter.add(41);
+    BOOST_TEST(counter.get_copy() == 42);
+
+    BOOST_TEST(counter.take() == 42);
+    BOOST_TEST(counter.get_copy() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentIncrements)
+{
+    striped_accumulator<std::int64_t> counter;
+    constexpr int nb_threads = 8;
+    constexpr int nb_iterations = 10000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nb_threads; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < nb_iterations; ++i) {
+                counter.with_locked([](std::int64_t& v) { ++v; });
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    BOOST_TEST(counter.get_copy() == nb_threads * nb_iterations);
+}
+
+BOOST_AUTO_TEST_CASE(UserDefinedReduce)
+{
+    striped_accumulator<stats, merge_stats> acc;
+
+    std::vector<std::thread> threads;
+    for (std::int64_t t = 1; t <= 4; ++t) {
+        threads.emplace_back([&acc, t]() {
+            for (std::int64_t i = 1; i <= 100; ++i) {
+                acc.with_locked([v = t * i](stats& s) {
+                    ++s.nb;
+                    s.total += v;
+                    s.max = std::max(s.max, v);
+                });
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    stats const all = acc.get_copy();
+    BOOST_TEST(all.nb == 400);
+    BOOST_TEST(all.total == (1 + 2 + 3 + 4) * 5050);
+    BOOST_TEST(all.max == 400);
+
+    // the identity is the default-constructed value
+    acc.take();
+    BOOST_TEST(acc.get_copy().nb == 0);
+    BOOST_TEST(acc.get_copy().max == std::numeric_limits<std::int64_t>::min());
+}
+
+BOOST_AUTO_TEST_CASE(CustomIdentity)
+{
+    auto const product = [](std::int64_t a, std::int64_t b) { return a * b; };
+    striped_accumulator<std::int64_t, decltype(product)> acc(1, product);
+
+    std::thread other([&acc]() { acc.add(3); });
+    other.join();
+    acc.add(7);
+
+    BOOST_TEST(acc.get_copy() == 21);
+}
+
+BOOST_AUTO_TEST_CASE(NotDefaultConstructible)
+{
+    static_assert(!std::is_default_constructible_v<histogram>);
+    striped_accumulator<histogram, merge_histograms> acc(histogram(4), {}, 2);
+
+    std::thread other([&acc]() { acc.with_locked([](histogram& h) { ++h.buckets[1]; }); });
+    other.join();
+    acc.with_locked([](histogram& h) { h.buckets[3] += 2; });
+
+    BOOST_TEST(acc.get_copy().buckets == std::vector<int>({0, 1, 0, 2}));
+    BOOST_TEST(acc.take().buckets.size() == 4u);
+    BOOST_TEST(acc.get_copy().buckets == std::vector<int>({0, 0, 0, 0}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
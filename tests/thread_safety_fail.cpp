@@ -0,0 +1,13 @@
+/* Built only with Clang and -Werror=thread-safety by the ThreadSafetyAnalysis
+   test, which expects this file to be rejected by the analysis.
+ */
+#include <string>
+
+#include "mutexed.hpp"
+
+using namespace llh::mutexed;
+
+void append(Mutexed<std::string>& words) LLH_MUTEXED_REQUIRES(words) {
+    // cannot call function 'with_locked' while mutexed 'words' is held
+    words.with_locked([](std::string& w) { w += "!"; });
+}
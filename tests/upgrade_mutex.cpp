@@ -0,0 +1,198 @@
+#define BOOST_TEST_MODULE UpgradeMutex
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mutexed/upgrade_mutex.hpp"
+
+using namespace llh::mutexed;
+
+static_assert(upgrade_lockable<upgrade_mutex>);
+static_assert(!upgrade_lockable<std::shared_mutex>);
+static_assert(downgradable<upgrade_mutex>);
+static_assert(!downgradable<std::shared_mutex>);
+
+
+BOOST_AUTO_TEST_SUITE(UpgradeMutexTests)
+
+BOOST_AUTO_TEST_CASE(Ownerships)
+{
+    upgrade_mutex m;
+
+    m.lock_upgrade();
+    // readers coexist with the upgrader, but not another upgrader nor a writer
+    BOOST_TEST(m.try_lock_shared());
+    BOOST_TEST(!m.try_lock_upgrade());
+    BOOST_TEST(!m.try_lock());
+    m.unlock_shared();
+    m.unlock_upgrade();
+
+    m.lock();
+    BOOST_TEST(!m.try_lock_shared());
+    BOOST_TEST(!m.try_lock_upgrade());
+    m.unlock_and_lock_upgrade();
+    BOOST_TEST(m.try_lock_shared());
+    m.unlock_shared();
+    m.unlock_upgrade_and_lock();
+    BOOST_TEST(!m.try_lock_shared());
+    m.unlock_and_lock_shared();
+    BOOST_TEST(m.try_lock_upgrade());
+    m.unlock_upgrade_and_lock_shared();
+    m.unlock_shared();
+    m.unlock_shared();
+
+    BOOST_TEST(m.try_lock());
+    m.unlock();
+}
+
+BOOST_AUTO_TEST_CASE(UpgradeWaitsForReaders)
+{
+    upgrade_mutex m;
+    std::atomic<bool> upgraded = false;
+
+    m.lock_shared();
+    std::thread upgrader([&]() {
+        m.lock_upgrade();
+        m.unlock_upgrade_and_lock();
+        upgraded = true;
+        m.unlock();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    BOOST_TEST(!upgraded);
+    // no new reader enters while the upgrader waits
+    BOOST_TEST(!m.try_lock_shared());
+
+    m.unlock_shared();
+    upgrader.join();
+    BOOST_TEST(upgraded);
+}
+
+BOOST_AUTO_TEST_CASE(WithUpgradeableLocked)
+{
+    Mutexed<std::map<int, std::string>, upgrade_mutex> cache;
+    auto get_or_compute = [&cache](int key) {
+        return cache.with_upgradeable_locked([key](auto& access) {
+            if (auto it = access->find(key); it != access->end()) {
+                return it->second;
+            }
+            return access.upgrade().emplace(key, std::to_string(key)).first->second;
+        });
+    };
+
+    BOOST_TEST(get_or_compute(1) == "1");
+    BOOST_TEST(get_or_compute(1) == "1");
+    BOOST_TEST(cache.get_copy().size() == 1u);
+
+    bool upgraded = true;
+    cache.with_upgradeable_locked([&upgraded](auto& access) { upgraded = access.upgraded(); });
+    BOOST_TEST(!upgraded);
+
+    // readers are not blocked by an upgradeable access
+    cache.with_upgradeable_locked([&cache](auto& access) {
+        std::size_t read_size = 0;
+        std::thread reader([&cache, &read_size]() { read_size = cache.get_copy().size(); });
+        reader.join();
+        BOOST_TEST(read_size == 1u);
+        BOOST_TEST(access->size() == 1u);
+    });
+}
+
+BOOST_AUTO_TEST_CASE(UpgradeNotifies)
+{
+    Mutexed<int, upgrade_mutex, has_cv> value(0);
+
+    std::thread waiter([&]() { value.wait([](int v) { return v == 1; }); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    value.with_upgradeable_locked([](auto& access) {
+        if (*access == 0) {
+            access.upgrade() = 1;
+        }
+    });
+    waiter.join();
+
+    BOOST_TEST(value.get_copy() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentUpgrades)
+{
+    Mutexed<int, upgrade_mutex> counter(0);
+    constexpr int nb_threads = 4;
+    constexpr int nb_iterations = 1000;
+
+    std::atomic<int> nb_bad_reads = 0;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nb_threads; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < nb_iterations; ++i) {
+                counter.with_upgradeable_locked([](auto& access) {
+                    int const read = *access;
+                    // nothing can write between the read and the upgrade
+                    access.upgrade() = read + 1;
+                });
+                if (counter.get_copy() <= 0) {
+                    ++nb_bad_reads;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    BOOST_TEST(nb_bad_reads == 0);
+    BOOST_TEST(counter.get_copy() == nb_threads * nb_iterations);
+}
+
+BOOST_AUTO_TEST_CASE(WithDowngradableLocked)
+{
+    Mutexed<int, upgrade_mutex, has_cv> value(0);
+    int reader_read = 0;
+
+    std::thread waiter([&]() { value.wait([](int v) { return v == 1; }); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    int const read = value.with_downgradable_locked([&](auto& access) {
+        *access = 1;
+        int const& v = access.downgrade();
+        BOOST_TEST(access.downgraded());
+        // the waiter is notified and readers proceed while the lock is still held
+        waiter.join();
+        std::thread reader([&]() { reader_read = value.get_copy(); });
+        reader.join();
+        return v;
+    });
+
+    BOOST_TEST(read == 1);
+    BOOST_TEST(reader_read == 1);
+}
+
+BOOST_AUTO_TEST_CASE(LockedDowngrade)
+{
+    Mutexed<int, upgrade_mutex, has_cv> value(0);
+
+    std::thread waiter([&]() { value.wait([](int v) { return v == 2; }); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    {
+        auto [lock, v] = value.locked();
+        v = 2;
+        int const& after = lock.downgrade();
+        waiter.join();
+        BOOST_TEST(value.get_copy() == after);
+    }
+
+    // the lock was released as a shared one
+    value.with_locked([](int& v) { ++v; });
+    BOOST_TEST(value.get_copy() == 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,83 @@
+#define BOOST_TEST_MODULE UsdtTracing
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <shared_mutex>
+#include <mutex>
+#include <string>
+#include <utility>
+
+// Compiles the probes in, if <sys/sdt.h> is available.
+#ifndef LLH_MUTEXED_USDT
+#define LLH_MUTEXED_USDT
+#endif
+#include "mutexed/usdt_tracing.hpp"
+
+using namespace llh::mutexed;
+
+#define STRINGIFY(...) #__VA_ARGS__
+#define EXPANSION(...) STRINGIFY(__VA_ARGS__)
+
+//! A mutex that counts the calls to its member functions.
+struct counting_mutex {
+    static inline int nb_lock = 0;
+    static inline int nb_try_lock = 0;
+    static inline int nb_unlock = 0;
+
+    std::mutex mtx;
+
+    void lock() { mtx.lock(); ++nb_lock; }
+    bool try_lock() { ++nb_try_lock; return mtx.try_lock(); }
+    void unlock() { ++nb_unlock; mtx.unlock(); }
+};
+
+
+BOOST_AUTO_TEST_SUITE(UsdtTracingTests)
+
+BOOST_AUTO_TEST_CASE(ProbedAccesses)
+{
+    // whether the probes are emitted or not, the accesses behave the same
+    Mutexed<int, traced_mutex<std::shared_mutex, usdt_tracer>, has_cv> a(1);
+    Mutexed<int, traced_mutex<std::mutex, usdt_tracer>> b(2);
+
+    a.with_locked([](int& v) { ++v; });
+    a.wait([](int v) { return v == 2; });
+    with_all_locked([](int& in_b, int const& in_a) { in_b += in_a; }, b, std::cref(a));
+
+    BOOST_TEST(a.get_copy() == 2);
+    BOOST_TEST(b.get_copy() == 4);
+}
+
+BOOST_AUTO_TEST_CASE(BuiltinProbes)
+{
+#if defined(__has_include) && __has_include(<sys/sdt.h>)
+    BOOST_TEST_MESSAGE("<sys/sdt.h> is available, the probes of Mutexed are compiled in");
+#else
+    // without <sys/sdt.h>, defining LLH_MUTEXED_USDT changes nothing
+    BOOST_TEST(std::string(EXPANSION(LLH_MUTEXED_USDT_PROBE(acquire_begin, nullptr, lock_mode::shared))).empty());
+    BOOST_TEST(std::string(EXPANSION(LLH_MUTEXED_USDT_PROBE1(mutex_notify, nullptr))).empty());
+    BOOST_TEST(std::string(EXPANSION(LLH_MUTEXED_USDT_NOTIFY(nullptr))).empty());
+    BOOST_TEST(std::string(EXPANSION(LLH_MUTEXED_USDT_ACQUIRED(nullptr, lock_mode::shared))).empty());
+    BOOST_TEST(std::string(EXPANSION(LLH_MUTEXED_USDT_LOCK_SCOPE(nullptr, lock_mode::exclusive))).empty());
+    BOOST_TEST(std::string(EXPANSION(LLH_MUTEXED_USDT_LOCKED())).empty());
+    BOOST_TEST(std::string(EXPANSION(LLH_MUTEXED_USDT_TRY_LOCK_SCOPE(nullptr, lock_mode::exclusive))).empty());
+    BOOST_TEST(std::string(EXPANSION(LLH_MUTEXED_USDT_TRIED(true))).empty());
+    BOOST_TEST(!usdt_tracer::enabled);
+#endif
+
+    // the probes do not change how the inner mutex is locked
+    Mutexed<int, counting_mutex, has_cv> counted(0);
+    counted.with_locked([](int& v) { ++v; });
+    counted.wait([](int v) { return v == 1; });
+    BOOST_TEST(counted.get_copy() == 1);
+    {
+        auto [lock, v] = counted.locked();
+        ++v;
+    }
+    BOOST_TEST(std::as_const(counted).try_with_locked([](int v) { return v; }).value() == 2);
+
+    BOOST_TEST(counting_mutex::nb_lock == 4);
+    BOOST_TEST(counting_mutex::nb_unlock == 5);
+    BOOST_TEST(counting_mutex::nb_try_lock == 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()